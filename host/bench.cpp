@@ -0,0 +1,206 @@
+// Tides 2 host benchmark
+// Drives the plugin through its factory the way the Disting NT does: sizes and
+// constructs an instance, then calls step() over many blocks for every
+// Ramp Mode x Range x Output Mode combination, with no CV inputs, each CV
+// input on its own, and all of them connected, for each Engine. With
+// --voices N the extra voices are enabled too, sharing the gate and pitch
+// inputs and writing to their own buses.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <distingnt/api.h>
+
+#include "instance.h"
+
+namespace {
+
+constexpr int kNumBuses = 28;
+constexpr int kNumBlockVariants = 64;   // distinct input blocks cycled through
+constexpr int kFirstInputBus = 1;
+constexpr int kFirstOutputBus = 13;
+constexpr int kFirstVoiceBus = 17;
+
+const char* const kInputNames[] = {
+    "Trig/Gate In", "V/Oct In", "FM In", "Shape In", "Slope In", "Smooth In", "Shift In",
+};
+constexpr int kNumInputs = sizeof(kInputNames) / sizeof(kInputNames[0]);
+
+const char* const kOutputNames[] = { "Output 1", "Output 2", "Output 3", "Output 4" };
+
+// Deterministic, slowly evolving CV on each input bus so that the gate,
+// pitch and modulation paths all see realistic activity.
+void fillInputs(float* busFrames, int numFrames, int variant, float sampleRate) {
+    for (int input = 0; input < kNumInputs; ++input) {
+        float* bus = busFrames + (kFirstInputBus - 1 + input) * numFrames;
+        for (int i = 0; i < numFrames; ++i) {
+            const float t = (float)(variant * numFrames + i) / sampleRate;
+            switch (input) {
+                case 0:  bus[i] = fmodf(t * 7.0f, 1.0f) < 0.5f ? 5.0f : 0.0f; break;
+                case 1:  bus[i] = sinf(t * 2.3f) * 1.0f; break;
+                case 2:  bus[i] = sinf(t * 31.0f) * 0.5f; break;
+                default: bus[i] = sinf(t * (0.7f + input)) * 4.0f; break;
+            }
+        }
+    }
+}
+
+struct Result {
+    double nsPerSample;
+    double samplesPerSecond;
+};
+
+Result run(Instance& instance, std::vector<float>& busFrames, int numFrames, long totalFrames) {
+    const int numFramesBy4 = numFrames / 4;
+    const size_t blockStride = (size_t)kNumBuses * numFrames;
+    const long numBlocks = totalFrames / numFrames;
+
+    // Warm up caches and let parameter smoothing settle.
+    for (int b = 0; b < kNumBlockVariants; ++b) {
+        instance.factory->step(instance.alg, busFrames.data() + b * blockStride, numFramesBy4);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    for (long b = 0; b < numBlocks; ++b) {
+        float* frames = busFrames.data() + (b % kNumBlockVariants) * blockStride;
+        instance.factory->step(instance.alg, frames, numFramesBy4);
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    const double samples = (double)numBlocks * numFrames;
+    return { ns / samples, samples * 1.0e9 / ns };
+}
+
+void usage() {
+    fprintf(stderr,
+        "usage: tides_bench [--seconds S] [--block FRAMES] [--voices N]\n"
+        "  --seconds S      audio rendered per combination (default 1.0)\n"
+        "  --block FRAMES   frames per step() call, multiple of 4 (default 32)\n"
+        "  --voices N       extra voices to enable (default 0)\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    double seconds = 1.0;
+    int numFrames = 32;
+    int voices = 0;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            numFrames = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--voices") && i + 1 < argc) {
+            voices = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (numFrames <= 0 || numFrames % 4 || numFrames > (int)NT_globals.maxFramesPerStep || seconds <= 0.0 ||
+        voices < 0 || kFirstVoiceBus + voices - 1 > kNumBuses) {
+        usage();
+        return 1;
+    }
+
+    const _NT_factory* factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, 0);
+    if (!factory) {
+        fprintf(stderr, "tides_bench: plugin has no factory\n");
+        return 1;
+    }
+
+    const float sampleRate = (float)NT_globals.sampleRate;
+    const long totalFrames = (long)(seconds * sampleRate);
+
+    std::vector<float> busFrames((size_t)kNumBlockVariants * kNumBuses * numFrames, 0.0f);
+    for (int b = 0; b < kNumBlockVariants; ++b) {
+        fillInputs(busFrames.data() + (size_t)b * kNumBuses * numFrames, numFrames, b, sampleRate);
+    }
+
+    printf("Tides 2 host benchmark: %s, %d frames/step, %.2f s per combination, %d extra voices\n",
+           factory->name, numFrames, seconds, voices);
+    printf("%-8s %-6s %-7s %-12s %-14s %10s %14s %8s\n",
+           "Engine", "Ramp", "Range", "Output", "CV inputs", "ns/sample", "samples/sec", "%48k");
+
+    // Engines, if the plugin has more than one
+    int numEngines = 1;
+    {
+        Instance probe;
+        if (!probe.create(factory, voices)) {
+            fprintf(stderr, "tides_bench: construct() failed\n");
+            return 1;
+        }
+        const int p = probe.tryFind("Engine");
+        if (p >= 0) numEngines = probe.alg->parameters[p].max + 1;
+    }
+
+    // Input configurations: none, each input alone, all of them.
+    const int numConfigs = kNumInputs + 2;
+    const int numCombinations = numEngines * numConfigs * 3 * 3 * 4;
+    const double realtime = 1.0e9 / sampleRate;
+
+    double worst = 0.0;
+    for (int c = 0; c < numCombinations; ++c) {
+        const int output = c % 4;
+        const int range = (c / 4) % 3;
+        const int ramp = (c / 12) % 3;
+        const int config = (c / 36) % numConfigs;
+        const int engine = c / (36 * numConfigs);
+
+        Instance instance;
+        if (!instance.create(factory, voices)) {
+            fprintf(stderr, "tides_bench: construct() failed\n");
+            return 1;
+        }
+        for (int o = 0; o < 4; ++o) {
+            const int p = instance.find(kOutputNames[o]);
+            instance.set(p, kFirstOutputBus + o);
+            instance.set(p + 1, 1);    // Replace, so the buses stay bounded
+        }
+        for (int voice = 0; voice < voices; ++voice) {
+            char name[32];
+            snprintf(name, sizeof(name), "Voice %d Trig", voice + 1);
+            instance.set(instance.find(name), kFirstInputBus);
+            snprintf(name, sizeof(name), "Voice %d V/Oct", voice + 1);
+            instance.set(instance.find(name), kFirstInputBus + 1);
+            snprintf(name, sizeof(name), "Voice %d Out", voice + 1);
+            const int p = instance.find(name);
+            instance.set(p, kFirstVoiceBus + voice);
+            instance.set(p + 1, 1);
+        }
+        for (int input = 0; input < kNumInputs; ++input) {
+            const bool connected = config == numConfigs - 1 || config == input + 1;
+            instance.set(instance.find(kInputNames[input]), connected ? kFirstInputBus + input : 0);
+        }
+        const int engineParam = instance.tryFind("Engine");
+        const int rampParam = instance.find("Ramp Mode");
+        const int rangeParam = instance.find("Range");
+        const int outputParam = instance.find("Output Mode");
+        if (engineParam >= 0) instance.set(engineParam, engine);
+        instance.set(rampParam, ramp);
+        instance.set(rangeParam, range);
+        instance.set(outputParam, output);
+
+        const Result r = run(instance, busFrames, numFrames, totalFrames);
+        if (r.nsPerSample > worst) worst = r.nsPerSample;
+
+        const char* inputs = config == 0 ? "none"
+            : config == numConfigs - 1 ? "all" : kInputNames[config - 1];
+        printf("%-8s %-6s %-7s %-12s %-14s %10.2f %14.0f %7.2f%%\n",
+               engineParam >= 0 ? instance.valueName(engineParam) : "-",
+               instance.valueName(rampParam),
+               instance.valueName(rangeParam),
+               instance.valueName(outputParam),
+               inputs,
+               r.nsPerSample,
+               r.samplesPerSecond,
+               100.0 * r.nsPerSample / realtime);
+    }
+    printf("Worst case: %.2f ns/sample\n", worst);
+    return 0;
+}
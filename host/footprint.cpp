@@ -0,0 +1,52 @@
+// Tides 2 per-instance memory footprint
+// Prints what calculateRequirements() asks for at every value of the
+// specifications, so the cost of adding instances is known before loading
+// them. Built for the host: structures holding pointers or size_t are
+// larger here than on the 32-bit NT, and both the algorithm (sram) and the
+// DTC state hold them, so sram and dtc are upper bounds for the same
+// maxFramesPerStep.
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <distingnt/api.h>
+
+int main() {
+    const _NT_factory* factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, 0);
+    if (!factory) {
+        fprintf(stderr, "tides_footprint: plugin has no factory\n");
+        return 1;
+    }
+
+    _NT_staticRequirements shared;
+    memset(&shared, 0, sizeof(shared));
+    if (factory->calculateStaticRequirements) factory->calculateStaticRequirements(shared);
+    printf("Shared by all instances: dram %u\n\n", (unsigned)shared.dram);
+
+    printf("Per-instance requirements (host build, maxFramesPerStep %d)\n",
+           (int)NT_globals.maxFramesPerStep);
+
+    std::vector<int32_t> specifications;
+    for (uint32_t i = 0; i < factory->numSpecifications; ++i) {
+        specifications.push_back(factory->specifications[i].def);
+    }
+
+    // One row per value of the first specification; a factory without
+    // specifications gets a single row
+    const _NT_specification* spec = factory->numSpecifications ? &factory->specifications[0] : nullptr;
+    const int first = spec ? spec->min : 0;
+    const int last = spec ? spec->max : 0;
+
+    printf("%-8s %8s %8s %8s %8s %8s\n", spec ? spec->name : "-", "params", "sram", "dram", "dtc", "itc");
+    for (int value = first; value <= last; ++value) {
+        if (spec) specifications[0] = value;
+        _NT_algorithmRequirements req;
+        memset(&req, 0, sizeof(req));
+        factory->calculateRequirements(req, specifications.data());
+        printf("%-8d %8u %8u %8u %8u %8u\n", value,
+               (unsigned)req.numParameters, (unsigned)req.sram, (unsigned)req.dram,
+               (unsigned)req.dtc, (unsigned)req.itc);
+    }
+    return 0;
+}
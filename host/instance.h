@@ -0,0 +1,121 @@
+// Host-side plugin instance
+// Sizes, allocates and constructs an algorithm through its factory the way
+// the Disting NT does, and sets parameters by name. Shared by the host tools.
+
+#ifndef TIDES_HOST_INSTANCE_H_
+#define TIDES_HOST_INSTANCE_H_
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <distingnt/api.h>
+
+struct Instance {
+    const _NT_factory* factory = nullptr;
+    _NT_algorithm* alg = nullptr;
+    _NT_algorithmRequirements req {};
+    std::vector<int32_t> specifications;
+    std::vector<int16_t> v;
+    void* memory[4] = { nullptr, nullptr, nullptr, nullptr };
+
+    Instance() = default;
+    Instance(const Instance&) = delete;
+    Instance& operator=(const Instance&) = delete;
+
+    ~Instance() {
+        for (void* m : memory) free(m);
+    }
+
+    static void* allocate(uint32_t size) {
+        // Tightly coupled memory on the NT is at least cache line aligned.
+        if (size == 0) return nullptr;
+        void* p = aligned_alloc(64, (size + 63) & ~63u);
+        memset(p, 0, size);
+        return p;
+    }
+
+    // Plugin-wide memory, allocated and initialised once per process
+    static void initialiseFactory(const _NT_factory* f) {
+        static const _NT_factory* initialised = nullptr;
+        if (initialised == f) return;
+        initialised = f;
+        _NT_staticRequirements req {};
+        if (f->calculateStaticRequirements) f->calculateStaticRequirements(req);
+        _NT_staticMemoryPtrs ptrs;
+        ptrs.dram = (uint8_t*)allocate(req.dram);      // Kept for the process
+        if (f->initialise) f->initialise(ptrs, req);
+    }
+
+    // voices > 0 overrides the "Voices" specification
+    bool create(const _NT_factory* f, int voices = 0) {
+        initialiseFactory(f);
+        factory = f;
+        for (uint32_t i = 0; i < f->numSpecifications; ++i) {
+            const _NT_specification& spec = f->specifications[i];
+            const bool isVoices = voices > 0 && !strcmp(spec.name, "Voices");
+            specifications.push_back(isVoices ? voices : spec.def);
+        }
+        f->calculateRequirements(req, specifications.data());
+
+        _NT_algorithmMemoryPtrs ptrs;
+        ptrs.sram = (uint8_t*)(memory[0] = allocate(req.sram));
+        ptrs.dram = (uint8_t*)(memory[1] = allocate(req.dram));
+        ptrs.dtc = (uint8_t*)(memory[2] = allocate(req.dtc));
+        ptrs.itc = (uint8_t*)(memory[3] = allocate(req.itc));
+        alg = f->construct(ptrs, req, specifications.data());
+        if (!alg) return false;
+
+        v.resize(req.numParameters);
+        for (uint32_t p = 0; p < req.numParameters; ++p) {
+            v[p] = alg->parameters[p].def;
+        }
+        alg->v = v.data();
+        alg->vIncludingCommon = v.data();
+        for (uint32_t p = 0; p < req.numParameters; ++p) {
+            f->parameterChanged(alg, p);
+        }
+        return true;
+    }
+
+    int tryFind(const char* name) const {
+        for (uint32_t p = 0; p < req.numParameters; ++p) {
+            if (strcmp(alg->parameters[p].name, name) == 0) return p;
+        }
+        return -1;
+    }
+
+    int find(const char* name) const {
+        const int p = tryFind(name);
+        if (p < 0) {
+            fprintf(stderr, "no parameter named \"%s\"\n", name);
+            exit(1);
+        }
+        return p;
+    }
+
+    void set(int p, int value) {
+        v[p] = value;
+        factory->parameterChanged(alg, p);
+    }
+
+    void set(const char* name, int value) {
+        set(find(name), value);
+    }
+
+    const char* valueName(int p) const {
+        const _NT_parameter& param = alg->parameters[p];
+        return param.enumStrings ? param.enumStrings[v[p] - param.min] : "?";
+    }
+
+    void midi(uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+        factory->midiMessage(alg, byte0, byte1, byte2);
+    }
+
+    void step(float* busFrames, int numFrames) {
+        factory->step(alg, busFrames, numFrames / 4);
+    }
+};
+
+#endif  // TIDES_HOST_INSTANCE_H_
@@ -0,0 +1,34 @@
+// Host-side stub of the Disting NT runtime
+// Provides the globals and drawing entry points that tides.cpp links against.
+
+#include <stdio.h>
+#include <distingnt/api.h>
+
+static float workBuffer[128 * 28];
+
+const _NT_globals NT_globals = {
+    .sampleRate = 48000,
+    .maxFramesPerStep = 128,
+    .workBuffer = workBuffer,
+    .workBufferSizeBytes = sizeof(workBuffer),
+};
+
+uint8_t NT_screen[128 * 64];
+
+void NT_drawText(int, int, const char*, int, _NT_textAlignment, _NT_textSize) {
+}
+
+void NT_drawShapeI(_NT_shape, int, int, int, int, int) {
+}
+
+int NT_intToString(char* buffer, int32_t value) {
+    return snprintf(buffer, 16, "%d", (int)value);
+}
+
+int NT_floatToString(char* buffer, float value, int decimalPlaces) {
+    return snprintf(buffer, 24, "%.*f", decimalPlaces, (double)value);
+}
+
+int32_t NT_algorithmIndex(const _NT_algorithm*) {
+    return 0;
+}
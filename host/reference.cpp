@@ -0,0 +1,181 @@
+// Tides 2 reference renderer
+// Built against the baseline tides.cpp and tides_dsp.h (make reference
+// extracts them from git), and renders the cases in reference.h into
+// host/reference/:
+//   - classic.ref: the baseline plugin, whose only engine is the classic one,
+//     rendered per sample. Its Frequency mode was rewritten later, so those
+//     slots hold the same 1:1 channel as Output 1 from another mode: Slope/
+//     Phase in AD and Cycle, and in AR Amplitude with Shift at 0, which puts
+//     all of the lowpassed or folded ramp on Output 1.
+//   - tides2.ref: the baseline's PolySlopeGenerator, fed the gate flags and
+//     per-sub-block CV that renderTides2() derives from the bus block.
+// host/reference/baseline.patch fixes three baseline bugs first: the garbled
+// integrated BLEP polynomials in tides_dsp.h, the lowpass state in a static
+// shared by every instance, and the main ramp's lowpass also running in
+// Slope/Phase mode, where it filtered Output 1 a second time.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <distingnt/api.h>
+
+#include "tides_dsp.h"
+#include "reference.h"
+
+namespace {
+
+constexpr int kNumBuses = 28;
+using reference::kBlock;
+constexpr int kSubBlockSize = 8;           // TIDES2_BLOCK_SIZE in tides.cpp
+constexpr int kOutputAmplitude = 1;
+constexpr int kOutputSlopePhase = 2;
+constexpr int kOutputFrequency = 3;
+constexpr int kRampAR = 2;
+
+// PolySlopeGenerator fed the way renderTides2() feeds it
+struct Tides2Reference {
+    tides::PolySlopeGenerator* poly = new tides::PolySlopeGenerator();
+    bool gateHigh = false;
+
+    Tides2Reference() { poly->Init(); }
+    ~Tides2Reference() { delete poly; }
+
+    void render(const float* busFrames, int numFrames, int ramp, int range, int output, int smoothnessSetting,
+                float sampleRate, float* out[4]) {
+        using namespace tides;
+        using reference::kSettings;
+        static const RampMode rampModes[] = { RAMP_MODE_AD, RAMP_MODE_LOOPING, RAMP_MODE_AR };
+        static const OutputMode outputModes[] = {
+            OUTPUT_MODE_GATES, OUTPUT_MODE_AMPLITUDE, OUTPUT_MODE_SLOPE_PHASE, OUTPUT_MODE_FREQUENCY
+        };
+        const Range polyRange = range == 2 ? RANGE_AUDIO : RANGE_CONTROL;
+
+        float v[reference::kNumSettings];
+        for (int s = 0; s < reference::kNumSettings; ++s) {
+            v[s] = kSettings[s].value / 100.0f;
+        }
+        v[3] = smoothnessSetting / 100.0f;
+        const float frequency = reference::kRangeFrequency[range] * expf(kSettings[0].value * 0.0577622650f);
+        const float baseFreq = frequency * (1.0f / sampleRate);
+
+        const float* in[reference::kNumInputs];
+        for (int k = 0; k < reference::kNumInputs; ++k) {
+            in[k] = busFrames + (reference::kFirstInputBus - 1 + k) * numFrames;
+        }
+
+        GateFlags flags[kSubBlockSize];
+        PolySlopeGenerator::OutputSample rendered[kSubBlockSize];
+        for (int start = 0; start < numFrames; start += kSubBlockSize) {
+            const int size = std::min(kSubBlockSize, numFrames - start);
+            for (int i = 0; i < size; ++i) {
+                const bool level = in[0][start + i] > 1.0f;
+                int f = level ? GATE_FLAG_HIGH : GATE_FLAG_LOW;
+                if (level && !gateHigh) f |= GATE_FLAG_RISING;
+                if (!level && gateHigh) f |= GATE_FLAG_FALLING;
+                flags[i] = (GateFlags)f;
+                gateHigh = level;
+            }
+
+            const float pitch = in[1][start] * 12.0f + in[2][start] * 12.0f * v[5];
+            const float f0 = pitch != 0.0f ? baseFreq * expf(pitch * 0.0577622650f) : baseFreq;
+            const float shape = std::clamp(v[1] + in[3][start] * 0.1f * v[6], 0.0f, 1.0f);
+            const float slope = std::clamp(v[2] + in[4][start] * 0.1f * v[7], 0.0f, 1.0f);
+            const float smoothness = std::clamp(v[3] + in[5][start] * 0.1f * v[8], 0.0f, 1.0f);
+            const float shift = std::clamp(v[4] + in[6][start] * 0.1f * v[9], 0.0f, 1.0f);
+
+            poly->Render(rampModes[ramp], outputModes[output], polyRange,
+                f0, slope, shape, smoothness, shift, flags, nullptr, rendered, size);
+            for (int ch = 0; ch < 4; ++ch) {
+                for (int i = 0; i < size; ++i) out[ch][start + i] = rendered[i].channel[ch];
+            }
+        }
+    }
+};
+
+// Append one case's outputs, frame by frame
+void append(std::vector<int16_t>& frames, float* const out[4], int numFrames) {
+    for (int i = 0; i < numFrames; ++i) {
+        for (int ch = 0; ch < 4; ++ch) frames.push_back(reference::toSample(out[ch][i]));
+    }
+}
+
+bool save(const char* dir, const char* name, const std::vector<int16_t>& frames) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE* f = fopen(path, "wb");
+    if (!f) {
+        fprintf(stderr, "tides_reference: cannot write %s\n", path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    reference::encode(frames, bytes);
+    const bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    fclose(f);
+    printf("Wrote %s (%zu frames, %zu bytes)\n", path, frames.size() / 4, bytes.size());
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: tides_reference DIR\n");
+        return 1;
+    }
+    const _NT_factory* factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, 0);
+    if (!factory || NT_globals.sampleRate != reference::kSampleRate) {
+        fprintf(stderr, "tides_reference: no baseline plugin at %d Hz\n", reference::kSampleRate);
+        return 1;
+    }
+
+    const float sampleRate = (float)NT_globals.sampleRate;
+    const long numBlocks = reference::kFrames / kBlock;
+    std::vector<float> busFrames((size_t)kNumBuses * kBlock, 0.0f);
+    std::vector<float> rendered((size_t)4 * kBlock);
+    float* out[4];
+    for (int ch = 0; ch < 4; ++ch) out[ch] = rendered.data() + ch * kBlock;
+
+    std::vector<int16_t> classic;
+    std::vector<int16_t> tides2;
+    for (int c = 0; c < reference::kNumCases; ++c) {
+        const int ramp = reference::caseRamp(c);
+        const int range = reference::caseRange(c);
+        const int output = reference::caseOutput(c);
+
+        Instance instance;
+        if (!instance.create(factory)) {
+            fprintf(stderr, "tides_reference: construct() failed\n");
+            return 1;
+        }
+        const int smoothness = reference::caseSmoothness(c);
+        if (output != kOutputFrequency) {
+            reference::configure(instance, ramp, range, output, reference::kFirstOutputBus, smoothness);
+        } else if (ramp != kRampAR) {
+            reference::configure(instance, ramp, range, kOutputSlopePhase, reference::kFirstOutputBus, smoothness);
+        } else {
+            reference::configure(instance, ramp, range, kOutputAmplitude, reference::kFirstOutputBus, smoothness);
+            instance.set("Shift", 0);
+            instance.set("Shift Atten", 0);
+        }
+        Tides2Reference poly;
+
+        for (long b = 0; b < numBlocks; ++b) {
+            reference::fillInputs(busFrames.data(), kBlock, b, sampleRate);
+            instance.step(busFrames.data(), kBlock);
+            float* const classicOut[4] = {
+                busFrames.data() + (reference::kFirstOutputBus - 1) * kBlock,
+                busFrames.data() + (reference::kFirstOutputBus) * kBlock,
+                busFrames.data() + (reference::kFirstOutputBus + 1) * kBlock,
+                busFrames.data() + (reference::kFirstOutputBus + 2) * kBlock,
+            };
+            append(classic, classicOut, kBlock);
+            poly.render(busFrames.data(), kBlock, ramp, range, output, smoothness, sampleRate, out);
+            append(tides2, out, kBlock);
+        }
+    }
+
+    return save(argv[1], "classic.ref", classic) && save(argv[1], "tides2.ref", tides2) ? 0 : 1;
+}
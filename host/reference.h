@@ -0,0 +1,158 @@
+// Reference renderings shared by tides_test and tides_reference
+// The cases, input signals and settings of the files in host/reference/,
+// which tides_reference renders from the baseline sources and tides_test
+// checks step() against. Changing anything here means rendering them again
+// (make reference).
+
+#ifndef TIDES_HOST_REFERENCE_H_
+#define TIDES_HOST_REFERENCE_H_
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "instance.h"
+
+namespace reference {
+
+constexpr int kFirstInputBus = 1;
+constexpr int kFirstOutputBus = 13;
+
+const char* const kInputNames[] = {
+    "Trig/Gate In", "V/Oct In", "FM In", "Shape In", "Slope In", "Smooth In", "Shift In",
+};
+constexpr int kNumInputs = sizeof(kInputNames) / sizeof(kInputNames[0]);
+
+const char* const kOutputNames[] = { "Output 1", "Output 2", "Output 3", "Output 4" };
+const char* const kRampNames[] = { "AD", "Cycle", "AR" };
+const char* const kRangeNames[] = { "Low", "Medium", "High" };
+const char* const kOutputModeNames[] = { "Gates", "Amplitude", "Slope/Phase", "Frequency" };
+
+// Main parameters for every case, away from their defaults so smoothing,
+// the attenuverters and FM are all exercised
+struct Setting {
+    const char* name;
+    int value;
+};
+
+const Setting kSettings[] = {
+    { "Frequency", 7 },
+    { "Shape", 30 },
+    { "Slope", 70 },
+    { "Smoothness", 65 },       // Then the case's, see kSmoothness
+    { "Shift", 40 },
+    { "FM Amount", 50 },
+    { "Shape Atten", 60 },
+    { "Slope Atten", -40 },
+    { "Smooth Atten", 30 },
+    { "Shift Atten", 50 },
+};
+constexpr int kNumSettings = sizeof(kSettings) / sizeof(kSettings[0]);
+
+// Range base frequencies from tides.cpp, for the Tides 2 reference
+const float kRangeFrequency[] = { 0.125f, 2.0f, 130.81f };
+
+// Smoothness of each half of the cases: the wavefolder, then the lowpass.
+// Smooth In moves it by up to 12%, so neither crosses 50%.
+const int kSmoothness[] = { 65, 20 };
+
+// Every Smoothness x Ramp Mode x Range x Output Mode, in that order of
+// significance
+constexpr int kNumCases = 72;
+inline int caseSmoothness(int c) { return kSmoothness[c / 36]; }
+inline int caseRamp(int c) { return (c / 12) % 3; }
+inline int caseRange(int c) { return (c / 4) % 3; }
+inline int caseOutput(int c) { return c % 4; }
+
+// The renderings: 0.25 s per case at 48 kHz in 32-frame step() calls (the
+// classic engine reads its CV once per call), frames of four outputs at
+// kScale volts per step, case after case. On disk each output is stored as
+// its change from the previous frame (from zero at the start of a case),
+// zigzag varint coded, which keeps the files small in the tree.
+constexpr int kSampleRate = 48000;
+constexpr long kFrames = kSampleRate / 4;
+constexpr int kBlock = 32;
+constexpr float kScale = 20.0f / 32767.0f;
+
+// The bench's input signals: a 7 Hz gate, slow V/Oct, FM and modulation
+inline void fillInputs(float* busFrames, int numFrames, long block, float sampleRate) {
+    for (int input = 0; input < kNumInputs; ++input) {
+        float* bus = busFrames + (kFirstInputBus - 1 + input) * numFrames;
+        for (int i = 0; i < numFrames; ++i) {
+            const float t = (float)(block * numFrames + i) / sampleRate;
+            switch (input) {
+                case 0:  bus[i] = fmodf(t * 7.0f, 1.0f) < 0.5f ? 5.0f : 0.0f; break;
+                case 1:  bus[i] = sinf(t * 2.3f) * 1.0f; break;
+                case 2:  bus[i] = sinf(t * 31.0f) * 0.5f; break;
+                default: bus[i] = sinf(t * (0.7f + input)) * 4.0f; break;
+            }
+        }
+    }
+}
+
+// Every CV input patched, the outputs on their own buses in Replace mode,
+// and the case's modes. The parameters exist in the baseline too.
+inline void configure(Instance& instance, int ramp, int range, int output, int firstOutputBus,
+                      int smoothness = kSmoothness[0]) {
+    for (int input = 0; input < kNumInputs; ++input) {
+        instance.set(kInputNames[input], kFirstInputBus + input);
+    }
+    for (int o = 0; o < 4; ++o) {
+        const int p = instance.find(kOutputNames[o]);
+        instance.set(p, firstOutputBus + o);
+        instance.set(p + 1, 1);    // Replace
+    }
+    for (const Setting& s : kSettings) {
+        instance.set(s.name, s.value);
+    }
+    instance.set("Smoothness", smoothness);
+    instance.set("Ramp Mode", ramp);
+    instance.set("Range", range);
+    instance.set("Output Mode", output);
+}
+
+inline int16_t toSample(float volts) {
+    const float x = roundf(volts / kScale);
+    return (int16_t)(x < -32767.0f ? -32767.0f : x > 32767.0f ? 32767.0f : x);
+}
+
+// Frames to the file format
+inline void encode(const std::vector<int16_t>& frames, std::vector<uint8_t>& bytes) {
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const bool first = i / 4 % kFrames == 0;
+        const int32_t delta = frames[i] - (first ? 0 : frames[i - 4]);
+        uint32_t z = ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+        for (; z >= 0x80; z >>= 7) bytes.push_back((uint8_t)(z | 0x80));
+        bytes.push_back((uint8_t)z);
+    }
+}
+
+// One file of kNumCases renderings, read whole
+inline bool load(const char* path, std::vector<int16_t>& frames) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> bytes;
+    for (int c; (c = fgetc(f)) != EOF;) bytes.push_back((uint8_t)c);
+    fclose(f);
+
+    frames.assign((size_t)kNumCases * kFrames * 4, 0);
+    size_t pos = 0;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        uint32_t z = 0;
+        for (int shift = 0;; shift += 7) {
+            if (pos == bytes.size() || shift > 28) return false;
+            const uint8_t b = bytes[pos++];
+            z |= (uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) break;
+        }
+        const int32_t delta = (int32_t)(z >> 1) ^ -(int32_t)(z & 1);
+        const bool first = i / 4 % kFrames == 0;
+        frames[i] = (int16_t)((first ? 0 : frames[i - 4]) + delta);
+    }
+    return pos == bytes.size();
+}
+
+}  // namespace reference
+
+#endif  // TIDES_HOST_REFERENCE_H_
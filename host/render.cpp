@@ -0,0 +1,388 @@
+// Tides 2 offline renderer
+// Runs a script of parameter settings and generated CV through step() and
+// writes the four outputs of each render to a file: 32-bit float WAV, or
+// interleaved float32 when the name ends in .raw. Every render is its own
+// instance, so renders are independent and run in parallel in --jobs
+// processes: instances share NT_globals.workBuffer, as they do on the NT,
+// where step() calls never overlap.
+//
+// Script, one directive per line; '#' starts a comment:
+//   seconds S                  length of the renders that follow (default 1)
+//   voices N                   Voices specification for the renders that follow
+//   set NAME=VALUE             parameter by name, e.g. "set Ramp Mode=1"
+//   bus N SIGNAL               CV on bus N (1-28) for the renders that follow:
+//                                const V | sine HZ AMP [OFFSET] |
+//                                square HZ AMP [OFFSET] | saw HZ AMP [OFFSET] | off
+//   sweep NAME=FROM:TO[:STEP]  the next render repeats for each value
+//   render FILE                render with everything set so far; with a
+//                              sweep, %d in FILE becomes the swept value
+// Outputs 1-4 start on buses 13-16 in Replace mode; "set" can move them.
+
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <distingnt/api.h>
+
+#include "instance.h"
+
+namespace {
+
+constexpr int kNumBuses = 28;
+constexpr int kFirstOutputBus = 13;
+constexpr int kNumChannels = 4;
+constexpr int kMaxVoices = 8;
+constexpr double kTwoPi = 6.283185307179586;
+
+const char* const kOutputNames[] = { "Output 1", "Output 2", "Output 3", "Output 4" };
+
+enum SignalType { SIGNAL_OFF, SIGNAL_CONST, SIGNAL_SINE, SIGNAL_SQUARE, SIGNAL_SAW };
+
+struct Signal {
+    SignalType type = SIGNAL_OFF;
+    float frequency = 0.0f;
+    float amplitude = 0.0f;
+    float offset = 0.0f;
+
+    float at(double t) const {
+        const double cycle = t * frequency - floor(t * frequency);
+        switch (type) {
+            case SIGNAL_CONST:  return offset;
+            case SIGNAL_SINE:   return offset + amplitude * (float)sin(kTwoPi * cycle);
+            case SIGNAL_SQUARE: return offset + (cycle < 0.5 ? amplitude : 0.0f);
+            case SIGNAL_SAW:    return offset + amplitude * (float)cycle;
+            default:            return 0.0f;
+        }
+    }
+};
+
+struct Setting {
+    std::string name;
+    int value;
+};
+
+// Everything one render needs, copied from the script state at "render"
+struct Job {
+    std::string path;
+    double seconds;
+    int voices;
+    std::vector<Setting> settings;
+    Signal buses[kNumBuses];
+    int line;
+};
+
+// Little-endian fields for the WAV header
+void put16(std::vector<uint8_t>& out, uint16_t v) {
+    out.push_back(v & 0xff);
+    out.push_back(v >> 8);
+}
+
+void put32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((v >> (8 * i)) & 0xff);
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+bool endsWith(const std::string& s, const char* suffix) {
+    const size_t n = strlen(suffix);
+    return s.size() >= n && s.compare(s.size() - n, n, suffix) == 0;
+}
+
+bool writeFile(const std::string& path, const std::vector<float>& frames, uint32_t sampleRate) {
+    FILE* file = fopen(path.c_str(), "wb");
+    if (!file) return false;
+    if (!endsWith(path, ".raw")) {
+        // WAVE_FORMAT_IEEE_FLOAT, with the fact chunk non-PCM formats carry
+        const uint32_t numFrames = (uint32_t)(frames.size() / kNumChannels);
+        const uint32_t dataBytes = (uint32_t)(frames.size() * sizeof(float));
+        std::vector<uint8_t> header;
+        putTag(header, "RIFF");
+        put32(header, 4 + (8 + 18) + (8 + 4) + (8 + dataBytes));
+        putTag(header, "WAVE");
+        putTag(header, "fmt ");
+        put32(header, 18);
+        put16(header, 3);
+        put16(header, kNumChannels);
+        put32(header, sampleRate);
+        put32(header, sampleRate * kNumChannels * sizeof(float));
+        put16(header, kNumChannels * sizeof(float));
+        put16(header, 32);
+        put16(header, 0);
+        putTag(header, "fact");
+        put32(header, 4);
+        put32(header, numFrames);
+        putTag(header, "data");
+        put32(header, dataBytes);
+        fwrite(header.data(), 1, header.size(), file);
+    }
+    const size_t written = fwrite(frames.data(), sizeof(float), frames.size(), file);
+    return fclose(file) == 0 && written == frames.size();
+}
+
+// Renders one job; false, with a message, if it cannot
+bool render(const _NT_factory* factory, const Job& job, int numFrames) {
+    Instance instance;
+    if (!instance.create(factory, job.voices)) {
+        fprintf(stderr, "line %d: construct() failed\n", job.line);
+        return false;
+    }
+    for (int o = 0; o < kNumChannels; ++o) {
+        const int p = instance.find(kOutputNames[o]);
+        instance.set(p, kFirstOutputBus + o);
+        instance.set(p + 1, 1);    // Replace
+    }
+    for (const Setting& s : job.settings) {
+        const int p = instance.tryFind(s.name.c_str());
+        if (p < 0) {
+            fprintf(stderr, "line %d: no parameter named \"%s\"\n", job.line, s.name.c_str());
+            return false;
+        }
+        instance.set(p, s.value);
+    }
+    int outputBus[kNumChannels];
+    for (int o = 0; o < kNumChannels; ++o) outputBus[o] = instance.v[instance.find(kOutputNames[o])];
+
+    const uint32_t sampleRate = NT_globals.sampleRate;
+    const long numBlocks = ((long)(job.seconds * sampleRate) + numFrames - 1) / numFrames;
+    std::vector<float> busFrames((size_t)kNumBuses * numFrames);
+    std::vector<float> frames((size_t)numBlocks * numFrames * kNumChannels);
+    for (long b = 0; b < numBlocks; ++b) {
+        for (int bus = 0; bus < kNumBuses; ++bus) {
+            float* block = busFrames.data() + (size_t)bus * numFrames;
+            const Signal& signal = job.buses[bus];
+            for (int i = 0; i < numFrames; ++i) {
+                block[i] = signal.at((double)(b * numFrames + i) / sampleRate);
+            }
+        }
+        instance.step(busFrames.data(), numFrames);
+        float* out = frames.data() + (size_t)b * numFrames * kNumChannels;
+        for (int ch = 0; ch < kNumChannels; ++ch) {
+            if (outputBus[ch] <= 0) continue;
+            const float* block = busFrames.data() + (size_t)(outputBus[ch] - 1) * numFrames;
+            for (int i = 0; i < numFrames; ++i) out[i * kNumChannels + ch] = block[i];
+        }
+    }
+    frames.resize((size_t)(job.seconds * sampleRate) * kNumChannels);
+
+    if (!writeFile(job.path, frames, sampleRate)) {
+        fprintf(stderr, "line %d: cannot write %s\n", job.line, job.path.c_str());
+        return false;
+    }
+    return true;
+}
+
+// "NAME=REST", split at the last '='
+bool splitAssignment(const std::string& text, std::string& name, std::string& rest) {
+    const size_t eq = text.rfind('=');
+    if (eq == std::string::npos || eq == 0) return false;
+    name = text.substr(0, eq);
+    rest = text.substr(eq + 1);
+    return true;
+}
+
+bool parseSignal(const char* text, Signal& signal) {
+    char type[16];
+    float a = 0.0f, b = 0.0f, c = 0.0f;
+    const int n = sscanf(text, "%15s %f %f %f", type, &a, &b, &c);
+    if (n < 1) return false;
+    if (!strcmp(type, "off")) {
+        signal = Signal();
+    } else if (!strcmp(type, "const") && n == 2) {
+        signal.type = SIGNAL_CONST;
+        signal.offset = a;
+    } else if (n >= 3) {
+        if (!strcmp(type, "sine")) signal.type = SIGNAL_SINE;
+        else if (!strcmp(type, "square")) signal.type = SIGNAL_SQUARE;
+        else if (!strcmp(type, "saw")) signal.type = SIGNAL_SAW;
+        else return false;
+        signal.frequency = a;
+        signal.amplitude = b;
+        signal.offset = n == 4 ? c : 0.0f;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Reads the script into jobs; false, with a message, on the first bad line
+bool parseScript(FILE* file, std::vector<Job>& jobs) {
+    Job state;
+    state.seconds = 1.0;
+    state.voices = 0;
+    bool sweeping = false;
+    std::string sweepName;
+    int sweepFrom = 0, sweepTo = 0, sweepStep = 1;
+
+    char buffer[512];
+    int line = 0;
+    while (fgets(buffer, sizeof(buffer), file)) {
+        ++line;
+        std::string text(buffer);
+        const size_t hash = text.find('#');
+        if (hash != std::string::npos) text.erase(hash);
+        while (!text.empty() && isspace((unsigned char)text.back())) text.pop_back();
+        const size_t start = text.find_first_not_of(" \t");
+        if (start == std::string::npos) continue;
+        text.erase(0, start);
+
+        const size_t space = text.find(' ');
+        const std::string directive = text.substr(0, space);
+        const std::string args = space == std::string::npos ? "" : text.substr(text.find_first_not_of(' ', space));
+
+        std::string name, value;
+        bool ok = true;
+        if (directive == "seconds") {
+            state.seconds = atof(args.c_str());
+            ok = state.seconds > 0.0;
+        } else if (directive == "voices") {
+            state.voices = atoi(args.c_str());
+            ok = state.voices >= 0 && state.voices <= kMaxVoices;
+        } else if (directive == "set") {
+            ok = splitAssignment(args, name, value);
+            if (ok) state.settings.push_back({ name, atoi(value.c_str()) });
+        } else if (directive == "bus") {
+            char* end = nullptr;
+            const long bus = strtol(args.c_str(), &end, 10);
+            ok = bus >= 1 && bus <= kNumBuses && parseSignal(end, state.buses[bus - 1]);
+        } else if (directive == "sweep") {
+            sweepStep = 1;
+            ok = splitAssignment(args, sweepName, value) &&
+                sscanf(value.c_str(), "%d:%d:%d", &sweepFrom, &sweepTo, &sweepStep) >= 2 &&
+                sweepStep != 0 && (sweepTo - sweepFrom) / sweepStep >= 0;
+            sweeping = ok;
+        } else if (directive == "render" && !args.empty()) {
+            state.path = args;
+            state.line = line;
+            if (!sweeping) {
+                jobs.push_back(state);
+            } else {
+                for (int v = sweepFrom; sweepStep > 0 ? v <= sweepTo : v >= sweepTo; v += sweepStep) {
+                    Job job = state;
+                    job.settings.push_back({ sweepName, v });
+                    const size_t field = args.find("%d");
+                    if (field != std::string::npos) {
+                        job.path.replace(field, 2, std::to_string(v));
+                    }
+                    jobs.push_back(job);
+                }
+                sweeping = false;
+            }
+        } else {
+            ok = false;
+        }
+        if (!ok) {
+            fprintf(stderr, "line %d: cannot read \"%s\"\n", line, text.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+void usage() {
+    fprintf(stderr,
+        "usage: tides_render [--jobs N] [--block FRAMES] SCRIPT\n"
+        "  --jobs N         renders run at once (default: one per core)\n"
+        "  --block FRAMES   frames per step() call, multiple of 4 (default 32)\n");
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    int jobs = (int)std::thread::hardware_concurrency();
+    int numFrames = 32;
+    const char* scriptPath = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--jobs") && i + 1 < argc) {
+            jobs = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            numFrames = atoi(argv[++i]);
+        } else if (argv[i][0] != '-' && !scriptPath) {
+            scriptPath = argv[i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    if (!scriptPath || numFrames <= 0 || numFrames % 4 || numFrames > (int)NT_globals.maxFramesPerStep) {
+        usage();
+        return 1;
+    }
+    if (jobs < 1) jobs = 1;
+
+    const _NT_factory* factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, 0);
+    if (!factory) {
+        fprintf(stderr, "tides_render: plugin has no factory\n");
+        return 1;
+    }
+
+    FILE* script = fopen(scriptPath, "r");
+    if (!script) {
+        fprintf(stderr, "tides_render: cannot open %s\n", scriptPath);
+        return 1;
+    }
+    std::vector<Job> queue;
+    const bool parsed = parseScript(script, queue);
+    fclose(script);
+    if (!parsed) return 1;
+
+    // Shared tables are built before any process constructs an instance
+    Instance::initialiseFactory(factory);
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<char> rendered(queue.size(), 0);
+    std::vector<std::pair<pid_t, size_t>> running;    // Process, job
+    auto reap = [&] {
+        int status = 0;
+        const pid_t pid = wait(&status);
+        for (size_t r = 0; r < running.size(); ++r) {
+            if (running[r].first != pid) continue;
+            rendered[running[r].second] = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            running.erase(running.begin() + r);
+            return;
+        }
+        running.clear();    // No children left
+    };
+    for (size_t j = 0; j < queue.size(); ++j) {
+        if ((int)running.size() >= jobs) reap();
+        fflush(stdout);
+        fflush(stderr);
+        const pid_t pid = fork();
+        if (pid == 0) {
+            const bool ok = render(factory, queue[j], numFrames);
+            fflush(stdout);
+            fflush(stderr);
+            _exit(ok ? 0 : 1);
+        }
+        if (pid < 0) {
+            rendered[j] = render(factory, queue[j], numFrames);
+        } else {
+            running.emplace_back(pid, j);
+        }
+    }
+    while (!running.empty()) reap();
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int files = 0;
+    double audio = 0.0;
+    for (size_t j = 0; j < queue.size(); ++j) {
+        if (!rendered[j]) continue;
+        ++files;
+        audio += queue[j].seconds;
+    }
+    printf("Rendered %d of %zu files, %.1f s of audio in %.2f s (%.0fx realtime, %d jobs)\n",
+           files, queue.size(), audio, elapsed, elapsed > 0.0 ? audio / elapsed : 0.0, jobs);
+    return files == (int)queue.size() ? 0 : 1;
+}
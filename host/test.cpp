@@ -0,0 +1,676 @@
+// Tides 2 reference tests
+// Renders every Ramp Mode x Range x Output Mode combination through step()
+// with all CV inputs connected, at Smoothness 65% (wavefolder) and 20%
+// (lowpass), and compares it with a reference:
+//   - Tides 2 engine: host/reference/tides2.ref, the baseline's
+//     PolySlopeGenerator driven directly (see host/reference.cpp)
+//   - Classic engine, per sample and at control rate: host/reference/
+//     classic.ref, the baseline plugin. Both are built from the baseline
+//     sources with host/reference/baseline.patch applied. Frequency mode was
+//     rewritten since, so only its Output 1 is compared: against the
+//     baseline's Output 1 in AD and Cycle (1:1 in every ratio set), and in AR
+//     against its Amplitude mode Output 1 with Shift at 0.
+//   - Lowpass: the Classic engine with Control Rate On against per sample,
+//     at a Smoothness that keeps every channel in its lowpass
+//   - Ramp In: a Tides 2 instance following another's Phase Out, in Cycle
+//     mode, against that master
+//   - Anti-Aliasing Auto: the Classic engine in Cycle mode against Off in
+//     Low/Medium range and On in High, whose pitches are all on one side of
+//     the threshold
+//   - MIDI voices: two voices played by note messages, against the same
+//     voices driven by the gate and V/Oct CV the allocator should produce
+//   - Output Add: the Classic engine adding onto buses that already carry a
+//     signal, against the same engine in Replace mode plus that signal
+//   - Envelope end: the Classic engine in AD and AR after one trigger, whose
+//     outputs must all be back at zero once the slowest channel has finished
+// Each case reports max abs / RMS error and fails when either is over the
+// budget for its mode. Gate outputs are compared as levels, see
+// Measurement::compareGates(). Exits non-zero on any failure. Each case also
+// reports the median cost of step() per sample against a host budget for its
+// mode; that is flagged but never fails, make bench times the target.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include <distingnt/api.h>
+
+#include "instance.h"
+#include "reference.h"
+
+namespace {
+
+using reference::kFirstInputBus;
+using reference::kFirstOutputBus;
+using reference::kInputNames;
+using reference::kNumInputs;
+using reference::kOutputNames;
+using reference::kRampNames;
+using reference::kRangeNames;
+using reference::kOutputModeNames;
+using reference::fillInputs;
+
+constexpr int kNumBuses = 28;
+constexpr int kFirstReferenceBus = 17;     // Classic reference instance
+constexpr int kPhaseBus = 25;              // Ramp In master's Phase Out
+constexpr int kFirstVoiceGateBus = 8;      // CV-driven voices' gates, then V/Oct
+constexpr int kSubBlockSize = 8;           // TIDES2_BLOCK_SIZE in tides.cpp
+constexpr int kControlRateDecimation = 8;  // CONTROL_RATE_DECIMATION in tides.cpp
+constexpr float kGateThreshold = 4.0f;     // Half the 8V gate level
+constexpr float kGateError = 8.0f;         // Reported for a misplaced gate
+
+// Per-mode budgets: error in volts, how many frames a gate edge may move
+// (negative: gates are compared as voltages), and the host cost of step()
+// in ns per sample, reported only. The costs are about twice what an -O2
+// x86 build measures, in the slowest range of the mode (High, per sample).
+struct Budget {
+    float maxError;
+    float rmsError;
+    int gateTolerance;
+    double nsPerSample;
+};
+
+// Tides 2 against PolySlopeGenerator; the slack covers Q15_SHAPE=1 and the
+// 16-bit reference
+const Budget kTides2Budget[3] = {
+    { 5.0e-3f, 1.0e-3f, -1, 400.0 },        // Low
+    { 5.0e-3f, 1.0e-3f, -1, 400.0 },        // Medium
+    { 5.0e-3f, 1.0e-3f, -1, 500.0 },        // High
+};
+
+// Classic per sample, Anti-Aliasing Off, against the baseline, by Output
+// Mode. The phase is fixed point now, which moves the audio-rate outputs by
+// a few tens of mV against the baseline's float phase, and an EOA or EOR edge
+// by up to a frame.
+const Budget kClassicBudget[4] = {
+    { 0.02f, 5.0e-4f, 1, 500.0 },           // Gates
+    { 0.04f, 1.0e-3f, 1, 600.0 },           // Amplitude
+    { 0.08f, 3.0e-3f, 1, 500.0 },           // Slope/Phase
+    { 0.06f, 2.0e-3f, 1, 1200.0 },          // Frequency (Output 1)
+};
+
+// Classic with Control Rate On against the baseline: at control rate in Low
+// and Medium range, per sample in High. Points are CONTROL_RATE_DECIMATION
+// samples apart and interpolated, so a gate edge can land up to two points
+// late.
+const Budget kControlRateBudget[4] = {
+    { 0.03f, 2.5e-3f, 2 * kControlRateDecimation, 500.0 },      // Gates
+    { 0.05f, 4.0e-3f, 2 * kControlRateDecimation, 600.0 },      // Amplitude
+    { 0.1f, 1.2e-2f, 2 * kControlRateDecimation, 500.0 },       // Slope/Phase
+    { 0.06f, 5.0e-3f, 2 * kControlRateDecimation, 1200.0 },     // Frequency (Output 1)
+};
+
+// Control Rate On against per sample with the Smoothness lowpass on every
+// channel, by Output Mode. At this setting the filter follows a step within
+// about five samples, which the points can only interpolate, so there is a
+// volt or two of error for a few samples after an output jumps at a trigger;
+// the RMS error is what catches a lowpass that drifts.
+constexpr int kLowpassSmoothness = 20;
+const Budget kLowpassBudget[4] = {
+    { 0.18f, 2.0e-3f, 2 * kControlRateDecimation, 100.0 },      // Gates
+    { 0.8f, 8.0e-3f, 2 * kControlRateDecimation, 100.0 },       // Amplitude
+    { 2.0f, 2.5e-2f, 2 * kControlRateDecimation, 100.0 },       // Slope/Phase
+    { 2.0f, 3.5e-2f, 2 * kControlRateDecimation, 100.0 },       // Frequency
+};
+
+// The AR Frequency reference is the baseline's Amplitude mode with Shift at
+// 0, whose smoothing starts from the middle
+constexpr long kArFrequencySettle = reference::kSampleRate / 10;
+
+// Ramp In slave against its master. In High range the anti-aliasing uses
+// the frequency measured from the ramp, which moves the band-limited edges of
+// Outputs 1 and 2 slightly and a gate edge by up to a frame.
+const Budget kRampInBudget[3] = {
+    { 1.0e-3f, 1.0e-4f, -1, 200.0 },        // Low
+    { 1.0e-3f, 1.0e-4f, -1, 200.0 },        // Medium
+    { 0.1f, 5.0e-4f, 1, 300.0 },            // High
+};
+
+// Anti-Aliasing Auto must pick the same kernels as Off or On every block
+const Budget kAntiAliasBudget = { 0.0f, 0.0f, -1, 1200.0 };
+
+// Add mode is the Replace output added to the bus, with nothing else changed
+const Budget kOutputAddBudget = { 0.0f, 0.0f, -1, 300.0 };
+
+// MIDI voices against CV voices. The CV gate of a voice retriggered in AD
+// mode drops for the last frame before the note.
+const Budget kMidiBudget = { 1.0e-4f, 1.0e-5f, -1, 150.0 };
+
+// Every output of a finished envelope is at rest. Frequency mode runs
+// channels at down to 1/8 of the main rate, so the check starts well after.
+const Budget kEnvelopeEndBudget = { 1.0e-4f, 1.0e-5f, -1, 200.0 };
+constexpr float kEnvelopeSeconds = 1.0f;        // Rendered per case
+constexpr float kEnvelopeSettle = 0.75f;        // Checked from here
+constexpr float kEnvelopeGate[2] = { 0.1f, 0.11f };    // Trigger, once Shift has settled
+
+// Note messages at the start of a block, with the voice each should reach:
+// round robin while a voice is free, then the oldest note is stolen
+struct NoteEvent {
+    long block;
+    uint8_t status;
+    uint8_t note;
+    int voice;
+};
+
+const NoteEvent kNoteEvents[] = {
+    { 0, 0x90, 48, 0 },
+    { 0, 0x90, 60, 1 },
+    { 200, 0x80, 48, 0 },
+    { 300, 0x90, 55, 0 },
+    { 400, 0x80, 60, 1 },
+    { 450, 0x90, 62, 1 },
+    { 500, 0x90, 64, 0 },   // Both held: steals 55, the oldest
+    { 650, 0x80, 64, 0 },
+    { 700, 0x80, 62, 1 },
+};
+constexpr int kNumMidiVoices = 2;
+
+void configure(Instance& instance, int engine, int ramp, int range, int output, int firstOutputBus,
+               int smoothness = reference::kSmoothness[0]) {
+    reference::configure(instance, ramp, range, output, firstOutputBus, smoothness);
+    instance.set("Engine", engine);
+}
+
+// Gate outputs: EOA and EOR in Gates mode
+bool isGate(int output, int ch) {
+    return output == 0 && ch >= 2;
+}
+
+// Error accumulated over one case
+struct Measurement {
+    double maxError = 0.0;
+    double sumSquares = 0.0;
+    long count = 0;
+
+    void compare(const float* a, const float* b, long n) {
+        for (long i = 0; i < n; ++i) {
+            const double d = fabs((double)a[i] - (double)b[i]);
+            if (!(d <= maxError)) maxError = d;    // NaN counts as a failure
+            sumSquares += d * d;
+        }
+        count += n;
+    }
+
+    // Gates as levels: a frame on the wrong side of the threshold counts a
+    // full gate of error unless it is within tolerance frames of a reference
+    // edge, and the number of edges must match
+    void compareGates(const float* a, const float* b, long n, int tolerance) {
+        std::vector<long> edges;
+        long edgesA = 0;
+        for (long i = 1; i < n; ++i) {
+            if ((b[i] > kGateThreshold) != (b[i - 1] > kGateThreshold)) edges.push_back(i);
+            if ((a[i] > kGateThreshold) != (a[i - 1] > kGateThreshold)) ++edgesA;
+        }
+        size_t next = 0;    // First reference edge after frame i - tolerance
+        for (long i = 0; i < n; ++i) {
+            while (next < edges.size() && edges[next] + tolerance <= i) ++next;
+            const bool nearEdge = next < edges.size() && edges[next] - tolerance <= i;
+            const bool wrong = (a[i] > kGateThreshold) != (b[i] > kGateThreshold);
+            const double d = !(a[i] == a[i]) ? NAN : wrong && !nearEdge ? kGateError : 0.0;
+            if (!(d <= maxError)) maxError = d;
+            sumSquares += d * d;
+        }
+        if (edgesA != (long)edges.size()) maxError = std::max(maxError, (double)kGateError);
+        count += n;
+    }
+
+    void compare(const float* a, const float* b, long n, int gateTolerance) {
+        if (gateTolerance < 0) {
+            compare(a, b, n);
+        } else {
+            compareGates(a, b, n, gateTolerance);
+        }
+    }
+
+    double rms() const { return count ? sqrt(sumSquares / count) : 0.0; }
+
+    // Median step() time of the instance under test, per sample
+    std::vector<double> blockNs;
+    long blockFrames = 0;
+
+    double nsPerSample() {
+        std::sort(blockNs.begin(), blockNs.end());
+        return blockNs.empty() ? 0.0 : blockNs[blockNs.size() / 2] / blockFrames;
+    }
+};
+
+void timedStep(Measurement& m, Instance& instance, float* busFrames, int numFrames) {
+    const auto start = std::chrono::steady_clock::now();
+    instance.step(busFrames, numFrames);
+    const auto end = std::chrono::steady_clock::now();
+    m.blockNs.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    m.blockFrames = numFrames;
+}
+
+// One case's outputs, channel by channel, appended block by block
+struct Rendering {
+    std::vector<float> out[4];
+
+    void append(const float* busFrames, int firstBus, int numFrames) {
+        for (int ch = 0; ch < 4; ++ch) {
+            const float* bus = busFrames + (firstBus - 1 + ch) * numFrames;
+            out[ch].insert(out[ch].end(), bus, bus + numFrames);
+        }
+    }
+
+    // Case c of a reference file
+    void load(const std::vector<int16_t>& frames, int c) {
+        const int16_t* frame = frames.data() + (size_t)c * reference::kFrames * 4;
+        for (int ch = 0; ch < 4; ++ch) {
+            out[ch].resize(reference::kFrames);
+            for (long i = 0; i < reference::kFrames; ++i) out[ch][i] = frame[i * 4 + ch] * reference::kScale;
+        }
+    }
+};
+
+struct Options {
+    double seconds = 0.5;
+    int numFrames = 32;
+};
+
+int slowCases = 0;
+
+bool report(const char* engine, int ramp, int range, int output, Measurement& m, const Budget& budget) {
+    const bool ok = m.maxError <= budget.maxError && m.rms() <= budget.rmsError;
+    const double ns = m.nsPerSample();
+    const bool slow = ns > budget.nsPerSample;
+    if (slow) ++slowCases;
+    printf("%-8s %-6s %-7s %-12s %10.3g %10.3g %10.3g %10.3g %9.1f %6.0f  %s%s\n",
+           engine, kRampNames[ramp], kRangeNames[range], kOutputModeNames[output],
+           m.maxError, m.rms(), budget.maxError, budget.rmsError, ns, budget.nsPerSample,
+           ok ? "ok" : "FAIL", slow ? " (slow)" : "");
+    return ok;
+}
+
+bool loadReference(const char* name, std::vector<int16_t>& frames) {
+    char path[256];
+    snprintf(path, sizeof(path), "host/reference/%s", name);
+    if (!reference::load(path, frames)) {
+        fprintf(stderr, "tides_test: cannot read %s (run from the repository root; make reference "
+                "renders it again)\n", path);
+        return false;
+    }
+    return true;
+}
+
+void usage() {
+    fprintf(stderr,
+        "usage: tides_test [--seconds S] [--block FRAMES]\n"
+        "  --seconds S      audio rendered per case without a reference file (default 0.5)\n"
+        "  --block FRAMES   frames per step() call, multiple of %d (default 32)\n", kSubBlockSize);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        if (!strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            options.seconds = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--block") && i + 1 < argc) {
+            options.numFrames = atoi(argv[++i]);
+        } else {
+            usage();
+            return 1;
+        }
+    }
+    const int numFrames = options.numFrames;
+    if (numFrames <= 0 || numFrames % kSubBlockSize || numFrames > (int)NT_globals.maxFramesPerStep ||
+        options.seconds <= 0.0) {
+        usage();
+        return 1;
+    }
+
+    const _NT_factory* factory = (const _NT_factory*)pluginEntry(kNT_selector_factoryInfo, 0);
+    if (!factory) {
+        fprintf(stderr, "tides_test: plugin has no factory\n");
+        return 1;
+    }
+    if (NT_globals.sampleRate != reference::kSampleRate) {
+        fprintf(stderr, "tides_test: the references are rendered at %d Hz\n", reference::kSampleRate);
+        return 1;
+    }
+    std::vector<int16_t> tides2Frames;
+    std::vector<int16_t> classicFrames;
+    if (!loadReference("tides2.ref", tides2Frames) || !loadReference("classic.ref", classicFrames)) {
+        return 1;
+    }
+
+    const float sampleRate = (float)NT_globals.sampleRate;
+    const long numBlocks = (long)(options.seconds * sampleRate) / numFrames;
+    const long referenceBlocks = reference::kFrames / reference::kBlock;
+    std::vector<float> busFrames((size_t)kNumBuses * numFrames, 0.0f);
+    std::vector<float> expected((size_t)4 * numFrames);
+
+    printf("Tides 2 reference tests: %d frames/step, %.2f s per case "
+           "(%d frames/step, %.2f s against host/reference)\n",
+           numFrames, options.seconds, reference::kBlock, (double)reference::kFrames / sampleRate);
+    printf("%-8s %-6s %-7s %-12s %10s %10s %10s %10s %9s %6s  %s\n",
+           "Engine", "Ramp", "Range", "Output", "max err", "rms err", "max budget", "rms budget",
+           "ns/sample", "budget", "result");
+
+    int cases = 0;
+    int failures = 0;
+
+    // Tides 2 engine against PolySlopeGenerator, and the Classic engine per
+    // sample and at control rate against the baseline, in the references'
+    // step() size
+    std::vector<float> referenceBus((size_t)kNumBuses * reference::kBlock, 0.0f);
+    for (int section = 0; section < 3; ++section) {
+        for (int c = 0; c < reference::kNumCases; ++c) {
+            const int ramp = reference::caseRamp(c);
+            const int range = reference::caseRange(c);
+            const int output = reference::caseOutput(c);
+            const int smoothness = reference::caseSmoothness(c);
+            const bool classic = section > 0;
+            const bool controlRate = section == 2;
+            const bool lowpass = smoothness < 50;
+
+            Instance instance;
+            if (!instance.create(factory)) {
+                fprintf(stderr, "tides_test: construct() failed\n");
+                return 1;
+            }
+            configure(instance, classic ? 0 : 1, ramp, range, output, kFirstOutputBus, smoothness);
+            if (classic) {
+                instance.set("Control Rate", controlRate ? 1 : 0);
+                instance.set("Anti-Aliasing", 0);
+            }
+
+            Measurement m;
+            Rendering rendered;
+            for (long b = 0; b < referenceBlocks; ++b) {
+                fillInputs(referenceBus.data(), reference::kBlock, b, sampleRate);
+                timedStep(m, instance, referenceBus.data(), reference::kBlock);
+                rendered.append(referenceBus.data(), kFirstOutputBus, reference::kBlock);
+            }
+            Rendering expectedRendering;
+            expectedRendering.load(classic ? classicFrames : tides2Frames, c);
+
+            const Budget& budget = !classic ? kTides2Budget[range]
+                                 : controlRate ? (lowpass ? kLowpassBudget : kControlRateBudget)[output]
+                                 : kClassicBudget[output];
+            // The baseline's AR Output 1 stands in once its Shift has settled
+            const long from = classic && output == 3 && ramp == 2 ? kArFrequencySettle : 0;
+            for (int ch = 0; ch < (classic && output == 3 ? 1 : 4); ++ch) {
+                m.compare(rendered.out[ch].data() + from, expectedRendering.out[ch].data() + from,
+                          reference::kFrames - from, isGate(output, ch) ? budget.gateTolerance : -1);
+            }
+            ++cases;
+            if (!report(!classic ? "Tides 2" : controlRate ? "Ctl Rate" : "Classic", ramp, range, output, m, budget)) {
+                ++failures;
+            }
+        }
+    }
+
+    // Smoothness lowpass at control rate against per sample, in the ranges
+    // that run at control rate. Smooth In keeps it below 50% throughout.
+    for (int c = 0; c < 24; ++c) {
+        const int output = c % 4;
+        const int range = (c / 4) % 2;
+        const int ramp = c / 8;
+
+        Instance instance;
+        Instance perSample;
+        if (!instance.create(factory) || !perSample.create(factory)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        configure(instance, 0, ramp, range, output, kFirstOutputBus);
+        configure(perSample, 0, ramp, range, output, kFirstReferenceBus);
+        for (Instance* i : { &instance, &perSample }) {
+            i->set("Smoothness", kLowpassSmoothness);
+            i->set("Anti-Aliasing", 0);
+        }
+        instance.set("Control Rate", 1);
+        perSample.set("Control Rate", 0);
+
+        Measurement m;
+        Rendering rendered;
+        Rendering expectedRendering;
+        for (long b = 0; b < numBlocks; ++b) {
+            fillInputs(busFrames.data(), numFrames, b, sampleRate);
+            timedStep(m, instance, busFrames.data(), numFrames);
+            perSample.step(busFrames.data(), numFrames);
+            rendered.append(busFrames.data(), kFirstOutputBus, numFrames);
+            expectedRendering.append(busFrames.data(), kFirstReferenceBus, numFrames);
+        }
+        const Budget& budget = kLowpassBudget[output];
+        for (int ch = 0; ch < 4; ++ch) {
+            m.compare(rendered.out[ch].data(), expectedRendering.out[ch].data(), (long)rendered.out[ch].size(),
+                      isGate(output, ch) ? budget.gateTolerance : -1);
+        }
+        ++cases;
+        if (!report("Lowpass", ramp, range, output, m, budget)) ++failures;
+    }
+
+    // Ramp In: a slave locked to a master's Phase Out in Cycle mode. High
+    // range Frequency mode runs its channels free, as on the module.
+    for (int c = 0; c < 12; ++c) {
+        const int output = c % 4;
+        const int range = c / 4;
+        const int ramp = 1;
+        if (range == 2 && output == 3) continue;
+
+        Instance master;
+        Instance slave;
+        if (!master.create(factory) || !slave.create(factory)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        configure(master, 1, ramp, range, output, kFirstOutputBus);
+        configure(slave, 1, ramp, range, output, kFirstReferenceBus);
+        master.set("Phase Out", kPhaseBus);
+        master.set("Phase Out mode", 1);
+        slave.set("Ramp In", kPhaseBus);
+
+        // Compared from the master's second trigger: the first, on frame 0,
+        // leaves its ramp at zero, which the slave cannot tell from a hold
+        const long settleBlocks = (long)(sampleRate / 7.0f) / numFrames + 1;
+        Measurement m;
+        Rendering masterRendering;
+        Rendering slaveRendering;
+        for (long b = 0; b < numBlocks; ++b) {
+            fillInputs(busFrames.data(), numFrames, b, sampleRate);
+            master.step(busFrames.data(), numFrames);
+            timedStep(m, slave, busFrames.data(), numFrames);
+            if (b < settleBlocks) continue;
+            masterRendering.append(busFrames.data(), kFirstOutputBus, numFrames);
+            slaveRendering.append(busFrames.data(), kFirstReferenceBus, numFrames);
+        }
+        for (int ch = 0; ch < 4; ++ch) {
+            m.compare(slaveRendering.out[ch].data(), masterRendering.out[ch].data(), (long)masterRendering.out[ch].size(),
+                      isGate(output, ch) ? kRampInBudget[range].gateTolerance : -1);
+        }
+        ++cases;
+        if (!report("Ramp In", ramp, range, output, m, kRampInBudget[range])) ++failures;
+    }
+
+    // Anti-Aliasing Auto against the fixed setting it should settle on,
+    // both rendered per sample
+    for (int c = 0; c < 12; ++c) {
+        const int output = c % 4;
+        const int range = c / 4;
+        const int ramp = 1;
+
+        Instance instance;
+        Instance fixed;
+        if (!instance.create(factory) || !fixed.create(factory)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        configure(instance, 0, ramp, range, output, kFirstOutputBus);
+        configure(fixed, 0, ramp, range, output, kFirstReferenceBus);
+        instance.set("Control Rate", 0);
+        fixed.set("Control Rate", 0);
+        instance.set("Anti-Aliasing", 1);
+        fixed.set("Anti-Aliasing", range == 2 ? 2 : 0);
+
+        Measurement m;
+        for (long b = 0; b < numBlocks; ++b) {
+            fillInputs(busFrames.data(), numFrames, b, sampleRate);
+            timedStep(m, instance, busFrames.data(), numFrames);
+            fixed.step(busFrames.data(), numFrames);
+            m.compare(busFrames.data() + (kFirstOutputBus - 1) * numFrames,
+                      busFrames.data() + (kFirstReferenceBus - 1) * numFrames, 4 * numFrames);
+        }
+        ++cases;
+        if (!report("Classic", ramp, range, output, m, kAntiAliasBudget)) ++failures;
+    }
+
+    // MIDI voices, in the envelope modes, against CV voices
+    for (int ramp = 0; ramp < 3; ramp += 2) {
+        Instance midi;
+        Instance cv;
+        if (!midi.create(factory, kNumMidiVoices) || !cv.create(factory, kNumMidiVoices)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        for (Instance* instance : { &midi, &cv }) {
+            configure(*instance, 0, ramp, 1, 0, kFirstOutputBus);
+            for (int o = 0; o < 4; ++o) instance->set(kOutputNames[o], 0);
+        }
+        midi.set("MIDI Channel", 1);
+        for (int v = 0; v < kNumMidiVoices; ++v) {
+            char name[32];
+            snprintf(name, sizeof(name), "Voice %d Trig", v + 1);
+            cv.set(name, kFirstVoiceGateBus + v);
+            snprintf(name, sizeof(name), "Voice %d V/Oct", v + 1);
+            cv.set(name, kFirstVoiceGateBus + kNumMidiVoices + v);
+            snprintf(name, sizeof(name), "Voice %d Out", v + 1);
+            midi.set(name, kFirstOutputBus + v);
+            cv.set(name, kFirstReferenceBus + v);
+            snprintf(name, sizeof(name), "Voice %d Out mode", v + 1);
+            midi.set(name, 1);
+            cv.set(name, 1);
+        }
+
+        bool gate[kNumMidiVoices] = {};
+        int note[kNumMidiVoices] = {};
+        Measurement m;
+        for (long b = 0; b < numBlocks; ++b) {
+            bool retrigger[kNumMidiVoices] = {};
+            for (const NoteEvent& e : kNoteEvents) {
+                if (e.block == b) {
+                    midi.midi(e.status, e.note, 100);
+                    gate[e.voice] = e.status == 0x90;
+                    note[e.voice] = e.note;
+                } else if (e.block == b + 1 && e.status == 0x90 && gate[e.voice]) {
+                    retrigger[e.voice] = true;
+                }
+            }
+            fillInputs(busFrames.data(), numFrames, b, sampleRate);
+            for (int v = 0; v < kNumMidiVoices; ++v) {
+                float* gateBus = busFrames.data() + (kFirstVoiceGateBus - 1 + v) * numFrames;
+                float* voctBus = gateBus + kNumMidiVoices * numFrames;
+                for (int i = 0; i < numFrames; ++i) {
+                    gateBus[i] = gate[v] ? 5.0f : 0.0f;
+                    voctBus[i] = (note[v] - 48) / 12.0f;
+                }
+                if (retrigger[v] && ramp == 0) gateBus[numFrames - 1] = 0.0f;
+            }
+            timedStep(m, midi, busFrames.data(), numFrames);
+            cv.step(busFrames.data(), numFrames);
+            m.compare(busFrames.data() + (kFirstOutputBus - 1) * numFrames,
+                      busFrames.data() + (kFirstReferenceBus - 1) * numFrames, kNumMidiVoices * numFrames);
+        }
+        ++cases;
+        if (!report("MIDI", ramp, 1, 0, m, kMidiBudget)) ++failures;
+    }
+
+    // Output Add against Replace plus what was on the bus, at control rate
+    // (Medium) and per sample (High)
+    for (int c = 0; c < 8; ++c) {
+        const int output = c % 4;
+        const int range = 1 + c / 4;
+        const int ramp = 1;
+
+        Instance adding;
+        Instance replacing;
+        if (!adding.create(factory) || !replacing.create(factory)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        configure(adding, 0, ramp, range, output, kFirstOutputBus);
+        configure(replacing, 0, ramp, range, output, kFirstReferenceBus);
+        adding.set("Control Rate", 1);
+        replacing.set("Control Rate", 1);
+        for (int o = 0; o < 4; ++o) adding.set(adding.find(kOutputNames[o]) + 1, 0);
+
+        Measurement m;
+        for (long b = 0; b < numBlocks; ++b) {
+            fillInputs(busFrames.data(), numFrames, b, sampleRate);
+            float* out = busFrames.data() + (kFirstOutputBus - 1) * numFrames;
+            for (int i = 0; i < 4 * numFrames; ++i) out[i] = (float)(i % 7) - 3.0f;
+            timedStep(m, adding, busFrames.data(), numFrames);
+            replacing.step(busFrames.data(), numFrames);
+            const float* replaced = busFrames.data() + (kFirstReferenceBus - 1) * numFrames;
+            for (int i = 0; i < 4 * numFrames; ++i) expected[i] = ((float)(i % 7) - 3.0f) + replaced[i];
+            m.compare(out, expected.data(), 4 * numFrames);
+        }
+        ++cases;
+        if (!report("Add", ramp, range, output, m, kOutputAddBudget)) ++failures;
+    }
+
+    // Envelope end: one trigger, with only Trig/Gate In patched, at a pitch
+    // where the slowest Frequency mode channel (Shift 0, 1/8) takes 0.5 s
+    // Gates mode is left out: its EOA and EOR gates stay high at the end.
+    for (int c = 0; c < 12; ++c) {
+        const int output = 1 + c % 3;
+        const int range = 1 + (c / 3) % 2;
+        const int ramp = c < 6 ? 0 : 2;
+
+        Instance instance;
+        if (!instance.create(factory)) {
+            fprintf(stderr, "tides_test: construct() failed\n");
+            return 1;
+        }
+        instance.set("Engine", 0);
+        instance.set("Ramp Mode", ramp);
+        instance.set("Range", range);
+        instance.set("Output Mode", output);
+        instance.set("Frequency", range == 2 ? 0 : 36);
+        instance.set("Shift", 0);
+        instance.set("Trig/Gate In", kFirstInputBus);
+        for (int o = 0; o < 4; ++o) {
+            const int p = instance.find(kOutputNames[o]);
+            instance.set(p, kFirstOutputBus + o);
+            instance.set(p + 1, 1);    // Replace
+        }
+
+        const long envelopeBlocks = (long)(kEnvelopeSeconds * sampleRate) / numFrames;
+        const long settleBlocks = (long)(kEnvelopeSettle * sampleRate) / numFrames;
+        const long gateStart = (long)(kEnvelopeGate[0] * sampleRate);
+        const long gateEnd = (long)(kEnvelopeGate[1] * sampleRate);
+        std::fill(expected.begin(), expected.end(), 0.0f);
+        Measurement m;
+        for (long b = 0; b < envelopeBlocks; ++b) {
+            std::fill(busFrames.begin(), busFrames.end(), 0.0f);
+            float* gate = busFrames.data() + (kFirstInputBus - 1) * numFrames;
+            for (int i = 0; i < numFrames; ++i) {
+                const long frame = b * numFrames + i;
+                gate[i] = frame >= gateStart && frame < gateEnd ? 5.0f : 0.0f;
+            }
+            timedStep(m, instance, busFrames.data(), numFrames);
+            if (b < settleBlocks) continue;
+            m.compare(busFrames.data() + (kFirstOutputBus - 1) * numFrames, expected.data(), 4 * numFrames);
+        }
+        ++cases;
+        if (!report("Env End", ramp, range, output, m, kEnvelopeEndBudget)) ++failures;
+    }
+
+    if (slowCases) {
+        printf("%d of %d cases over their ns/sample budget (reported only)\n", slowCases, cases);
+    }
+    if (failures) {
+        printf("FAILED: %d of %d cases over budget\n", failures, cases);
+        return 1;
+    }
+    printf("All %d cases passed\n", cases);
+    return 0;
+}
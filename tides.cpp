@@ -5,9 +5,13 @@
 
 #include <math.h>
 #include <new>
+#include <atomic>
 #include <cstring>
+#include <cstddef>
 #include <distingnt/api.h>
 
+#include "tides_dsp.h"
+
 // ============================================================================
 // Constants
 // ============================================================================
@@ -43,13 +47,60 @@ enum OutputMode {
     OUT_FREQUENCY = 3     // Polyrhythmic divisions
 };
 
+enum Engine {
+    ENGINE_CLASSIC = 0,   // Per-sample implementation below
+    ENGINE_TIDES2 = 1     // Block-based PolySlopeGenerator from tides_dsp.h
+};
+
+enum AntiAliasing {
+    ANTI_ALIAS_OFF = 0,   // Naive slope and gates
+    ANTI_ALIAS_AUTO = 1,  // Band-limited only above BLEP_ON_INCREMENT
+    ANTI_ALIAS_ON = 2     // Band-limited whenever the engine renders per sample
+};
+
+// Sub-block size for the Tides 2 engine (as on the original module)
+static constexpr int TIDES2_BLOCK_SIZE = 8;
+
+// Phase Out and Ramp In span 0-8V, so the phase survives the trip through a
+// bus exactly. A larger step per frame than the engine's frequency limit is
+// a reset of the master, not motion.
+static constexpr float PHASE_VOLTS = 8.0f;
+static constexpr float RAMP_IN_MAX_INCREMENT = 0.25f;
+
+// Classic Cycle mode, Anti-Aliasing Auto: a block runs the polyBLEP kernels
+// once the phase increment (cycles per sample) at its start is over
+// BLEP_ON_INCREMENT, about 47 Hz at 48 kHz, and goes back to the naive ones
+// below BLEP_OFF_INCREMENT, so a pitch near the threshold does not flip
+// between them every block.
+static constexpr float BLEP_ON_INCREMENT = 1.0f / 1024.0f;
+static constexpr float BLEP_OFF_INCREMENT = BLEP_ON_INCREMENT * 0.5f;
+
+// Classic engine, Control Rate On: a block is computed every
+// CONTROL_RATE_DECIMATION samples while the phase increment at its start is
+// under CONTROL_RATE_ON_INCREMENT, about 12 Hz at 48 kHz, where a point is
+// 1/512 of a cycle, and per sample again over CONTROL_RATE_OFF_INCREMENT.
+static constexpr float CONTROL_RATE_ON_INCREMENT = 1.0f / 4096.0f;
+static constexpr float CONTROL_RATE_OFF_INCREMENT = CONTROL_RATE_ON_INCREMENT * 2.0f;
+
 // ============================================================================
 // DTC Memory (fast memory for real-time DSP)
 // ============================================================================
 
-struct _TidesDTC {
-    // Phase accumulators (0.0 to 1.0)
-    float phase[4];
+// Cortex-M7 data cache line. Every DTC region starts on one so the
+// per-channel arrays of the 4-channel loops never straddle two lines.
+static constexpr size_t DTC_CACHE_LINE = 32;
+
+struct alignas(DTC_CACHE_LINE) _TidesDTC {
+    // Main phase accumulator (fixed point, see PHASE_SCALE)
+    uint32_t phase;
+    
+    // Lowpass state for smoothness processing, per channel
+    float lp_state[4];
+    
+    // Control-rate rendering: last computed point per channel, and whether
+    // the previous block was rendered at control rate
+    float control_last[4];
+    bool control_rate;
     
     // Gate state
     bool gate_high;
@@ -65,18 +116,337 @@ struct _TidesDTC {
     float smooth_slope;
     float smooth_smoothness;
     float smooth_shift;
+    
+    // Frequency mode, as in RampGenerator: each channel's ratio, and the
+    // master phase wraps since the channel last took a new one
+    tides::Ratio ratio[4];
+    int wrap_counter[4];
+    tides::HysteresisQuantizer2 ratio_quantizer;
+    
+    // Frequency mode envelopes (AD, and AR with a gate): each channel runs
+    // its own phase at its ratio from the trigger to the end, as in
+    // RampGenerator, since the master phase stops there. They are set up
+    // for channel_ramp_mode (-1 = not yet).
+    uint32_t channel_phase[4];
+    int channel_ramp_mode;
+    
+    // Band-limited kernels: one polyBLEP shaper per output, and whether
+    // the previous block ran them
+    tides::RampShaper shaper[4];
+    bool band_limited;
+};
+
+static_assert(offsetof(_TidesDTC, lp_state) + sizeof(float) * 4 <= DTC_CACHE_LINE,
+              "phase and per-channel filter state should share one cache line");
+
+// Extra envelope voices ("Voices" specification), stored as structure of
+// arrays in DTC so one loop steps every voice per sample
+static constexpr int MAX_VOICES = 8;
+
+struct _TidesVoices {
+    int count;
+    
+    // One entry per voice
+    uint32_t* phase;            // Fixed point, see PHASE_SCALE
+    float* lp_state;
+    float* phase_inc;           // From the voice's V/Oct, once per block
+    uint8_t* gate_high;
+    uint8_t* envelope_running;
+    
+    // Shared parameters, smoothed once per sample for all voices
+    float smooth_shape;
+    float smooth_slope;
+    float smooth_smoothness;
+};
+
+// MIDI voice allocation ("MIDI Channel"): the note each voice plays, handed
+// out round robin over the voices with no note held, stealing the oldest
+// note when every voice is held. Fixed size, changed only by midiMessage()
+// and read once per block.
+static constexpr int MIDI_NOTE_ZERO_VOLTS = 48;     // C3, the High range base
+
+struct VoiceAllocator {
+    uint8_t note[MAX_VOICES];
+    bool held[MAX_VOICES];          // Note on, no note off yet
+    bool retrigger[MAX_VOICES];     // Note on since the last block
+    uint32_t age[MAX_VOICES];       // Order of the note ons
+    uint32_t counter;
+    int last;                       // Voice of the latest note on
+};
+
+// Clock In period tracker. The period is kept in 1/16 sample units so the
+// integer smoothing does not stall a sample short of the real period.
+static constexpr int CLOCK_PERIOD_SHIFT = 4;
+static constexpr float CLOCK_TIMEOUT_SECONDS = 10.0f;
+
+struct ClockTracker {
+    uint32_t counter;           // Samples since the last rising edge
+    uint32_t period;            // Smoothed period << CLOCK_PERIOD_SHIFT, 0 = unknown
+    int edges;                  // Rising edges since the last phase sync
+    bool high;
+    bool started;               // counter is measuring from a rising edge
 };
 
 // ============================================================================
-// Algorithm Structure
+// Profiling (build with PROFILE=1)
 // ============================================================================
 
-struct _TidesAlgorithm : public _NT_algorithm {
-    _TidesAlgorithm(_TidesDTC* dtc_) : dtc(dtc_) {}
-    ~_TidesAlgorithm() {}
+#ifdef TIDES_PROFILE
+
+// Core clock used to express cycles as a share of the sample period
+static constexpr float PROFILE_CPU_HZ = 480000000.0f;
+
+// Cycle statistics for step(), latched about once per second for draw()
+struct TidesProfile {
+    uint32_t block_min;
+    uint32_t block_max;
+    uint64_t block_total;
+    uint32_t blocks;
+    uint32_t frames;
+    float sample_min;
+    float sample_max;
     
-    _TidesDTC* dtc;
-    float inv_sample_rate;
+    // Last latched window
+    uint32_t shown_block_min;
+    uint32_t shown_block_avg;
+    uint32_t shown_block_max;
+    float shown_sample_min;
+    float shown_sample_avg;
+    float shown_sample_max;
+};
+
+#if defined(__arm__)
+// Cortex-M7 DWT cycle counter
+static inline uint32_t readCycleCounter() {
+    return *(volatile uint32_t*)0xE0001004;     // DWT_CYCCNT
+}
+
+static void enableCycleCounter() {
+    *(volatile uint32_t*)0xE000EDFC |= 1u << 24;    // DEMCR.TRCENA
+    *(volatile uint32_t*)0xE0001FB0 = 0xC5ACCE55;   // DWT_LAR unlock
+    *(volatile uint32_t*)0xE0001000 |= 1u;          // DWT_CTRL.CYCCNTENA
+}
+#elif defined(__x86_64__) || defined(__i386__)
+// Host builds: time stamp counter, so the bench can exercise this path
+#include <x86intrin.h>
+static inline uint32_t readCycleCounter() {
+    return (uint32_t)__rdtsc();
+}
+
+static void enableCycleCounter() {}
+#else
+static inline uint32_t readCycleCounter() {
+    return 0;
+}
+
+static void enableCycleCounter() {}
+#endif
+
+static void resetProfileWindow(TidesProfile& prof) {
+    prof.block_min = UINT32_MAX;
+    prof.block_max = 0;
+    prof.block_total = 0;
+    prof.blocks = 0;
+    prof.frames = 0;
+    prof.sample_min = 1.0e9f;
+    prof.sample_max = 0.0f;
+}
+
+static void recordProfile(TidesProfile& prof, uint32_t cycles, int numFrames) {
+    const float perSample = (float)cycles / (float)numFrames;
+    
+    if (cycles < prof.block_min) prof.block_min = cycles;
+    if (cycles > prof.block_max) prof.block_max = cycles;
+    if (perSample < prof.sample_min) prof.sample_min = perSample;
+    if (perSample > prof.sample_max) prof.sample_max = perSample;
+    prof.block_total += cycles;
+    prof.blocks += 1;
+    prof.frames += numFrames;
+    
+    if (prof.frames >= NT_globals.sampleRate) {
+        prof.shown_block_min = prof.block_min;
+        prof.shown_block_avg = (uint32_t)(prof.block_total / prof.blocks);
+        prof.shown_block_max = prof.block_max;
+        prof.shown_sample_min = prof.sample_min;
+        prof.shown_sample_avg = (float)prof.block_total / (float)prof.frames;
+        prof.shown_sample_max = prof.sample_max;
+        resetProfileWindow(prof);
+    }
+}
+
+#endif  // TIDES_PROFILE
+
+// ============================================================================
+// ITCM Kernels (build with ITCM=1)
+// ============================================================================
+
+// The per-mode render loops are emitted into their own section. Far too
+// many of them are specialised to fit in ITCM, so each instance keeps a few
+// slots of ITC memory and copies in the kernels its blocks actually use,
+// which it then runs without flash wait states or competing for the cache.
+// Parameter handling, UI and the block setup stay in flash. The ARM build
+// adds -mlong-calls, so calls out of a copied kernel reach their target.
+#ifdef TIDES_ITCM
+
+// GCC ignores section attributes on template instances, so each kernel is
+// inlined into a plain function that carries the attribute
+#define TIDES_ITCM_CODE __attribute__((section(".text.tides_itcm"), noinline))
+#define TIDES_ITCM_INLINE __attribute__((always_inline)) inline
+
+// End of the section: GCC outputs top-level asm before any function, and
+// subsection 8191 is placed after everything it puts in subsection 0
+asm(".pushsection .text.tides_itcm, \"ax\", %progbits\n"
+    ".subsection 8191\n"
+    "tides_itcm_end:\n"
+    ".popsection\n");
+extern "C" const uint8_t tides_itcm_end[];
+
+static constexpr int ITCM_CLASSIC_SLOTS = 2;    // Routing variants held at once
+static constexpr int ITCM_SLOTS = ITCM_CLASSIC_SLOTS + 1;   // Then the voice kernel
+static constexpr uintptr_t ITCM_ALIGN = 8;      // Copies keep the address mod 8
+
+static constexpr uintptr_t itcmAlign(uintptr_t size) {
+    return (size + ITCM_ALIGN - 1) & ~(ITCM_ALIGN - 1);
+}
+
+struct ItcmSlot {
+    uint8_t* code;              // In ITC memory, ITCM_ALIGN aligned
+    uint32_t capacity;
+    uintptr_t loaded;           // Address of the kernel it holds, 0 = none
+    uint32_t last_use;
+};
+
+struct ItcmCache {
+    ItcmSlot slots[ITCM_SLOTS];
+    uint32_t clock;
+};
+
+// Entry point of every kernel in the section, sorted, so each kernel runs
+// to the next one (the last to tides_itcm_end); filled by scanItcmCode(),
+// after the kernel tables
+static constexpr int ITCM_MAX_KERNELS = 160;
+
+struct ItcmCode {
+    uintptr_t start[ITCM_MAX_KERNELS];
+    int count;
+    uint32_t max_classic;       // Largest classic and voice kernel, bytes
+    uint32_t max_voice;
+    bool scanned;
+};
+
+static ItcmCode itcmCode;
+static void scanItcmCode();
+
+// Code address of a kernel, without the Thumb bit
+template <typename Kernel>
+static inline uintptr_t codeAddress(Kernel kernel) {
+    return reinterpret_cast<uintptr_t>(kernel) & ~(uintptr_t)1;
+}
+
+static uint32_t itcmExtent(uintptr_t start) {
+    const ItcmCode& code = itcmCode;
+    int lo = 0;
+    int hi = code.count;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (code.start[mid] <= start) lo = mid + 1; else hi = mid;
+    }
+    const uintptr_t end = lo < code.count ? code.start[lo] : (uintptr_t)tides_itcm_end;
+    return (uint32_t)(end - start);
+}
+
+// ITC memory for the slots: classic, then the voice slot if there are voices
+static uint32_t itcmSize(int numVoices) {
+    scanItcmCode();
+    const uint32_t classic = (uint32_t)itcmAlign(itcmCode.max_classic + ITCM_ALIGN);
+    const uint32_t voice = numVoices > 0 ? (uint32_t)itcmAlign(itcmCode.max_voice + ITCM_ALIGN) : 0;
+    return ITCM_CLASSIC_SLOTS * classic + voice + ITCM_ALIGN - 1;
+}
+
+static void initItcm(ItcmCache& cache, uint8_t* itc, int numVoices) {
+    scanItcmCode();
+    uint8_t* p = (uint8_t*)itcmAlign((uintptr_t)itc);
+    for (int s = 0; s < ITCM_SLOTS; ++s) {
+        ItcmSlot& slot = cache.slots[s];
+        const bool voice = s == ITCM_CLASSIC_SLOTS;
+        slot.code = p;
+        slot.capacity = voice && numVoices == 0 ? 0
+            : (uint32_t)itcmAlign((voice ? itcmCode.max_voice : itcmCode.max_classic) + ITCM_ALIGN);
+        slot.loaded = 0;
+        slot.last_use = 0;
+        p += slot.capacity;
+    }
+    cache.clock = 0;
+}
+
+// The kernel to call for this block: its copy in one of the slots
+// [first, first + count), loaded into the least recently used on a miss.
+// Host builds copy the code too but run it from where it is.
+template <typename Kernel>
+static Kernel itcmKernel(ItcmCache& cache, int first, int count, Kernel kernel) {
+    const uintptr_t start = codeAddress(kernel);
+    ItcmSlot* slot = nullptr;
+    ItcmSlot* victim = &cache.slots[first];
+    for (int s = first; s < first + count; ++s) {
+        if (cache.slots[s].loaded == start) slot = &cache.slots[s];
+        if (cache.slots[s].last_use < victim->last_use) victim = &cache.slots[s];
+    }
+    if (!slot) {
+        const uint32_t size = itcmExtent(start);
+        if (size + (start & (ITCM_ALIGN - 1)) > victim->capacity) return kernel;
+        slot = victim;
+        memcpy(slot->code + (start & (ITCM_ALIGN - 1)), (const void*)start, size);
+#if defined(__arm__)
+        __asm__ volatile("dsb 0xF\n isb 0xF" ::: "memory");
+#endif
+        slot->loaded = start;
+    }
+    slot->last_use = ++cache.clock;
+#if defined(__arm__)
+    return reinterpret_cast<Kernel>((uintptr_t)slot->code + (start & (ITCM_ALIGN - 1)) +
+        (reinterpret_cast<uintptr_t>(kernel) & 1));
+#else
+    return kernel;
+#endif
+}
+
+#else
+#define TIDES_ITCM_INLINE
+#endif  // TIDES_ITCM
+
+// ============================================================================
+// Scope (draw() display of the four outputs)
+// ============================================================================
+
+// step() publishes one min/max column per output every few blocks into a
+// single-producer/single-consumer ring; draw() shows the newest screen's
+// worth. The ring holds two screens, so step() can never lap a column that
+// draw() is reading, and neither side ever waits.
+static constexpr int SCOPE_WIDTH = 256;
+static constexpr uint32_t SCOPE_RING_SIZE = 512;    // Power of two
+static constexpr float SCOPE_VOLTS_TO_Q7 = 12.7f;   // ±10V full scale
+
+// Time across the screen for each Range
+static constexpr float SCOPE_WINDOW_SECONDS[] = { 8.0f, 1.0f, 0.1f };
+
+// Samples a column's min/max is taken from; the rest are not looked at
+static constexpr int SCOPE_POINTS_PER_COLUMN = 8;
+
+struct ScopeColumn {
+    int8_t min[4];
+    int8_t max[4];
+};
+
+struct TidesScope {
+    ScopeColumn ring[SCOPE_RING_SIZE];
+    std::atomic<uint32_t> written;      // Columns published; stored by step() only
+    std::atomic<float> phase;           // Main ramp phase at the end of the last block
+    
+    // Column being accumulated, owned by step()
+    float pending_min[4];
+    float pending_max[4];
+    int pending_frames;
+    int next_point;                     // Frame of the next sample in the coming block
 };
 
 // ============================================================================
@@ -122,12 +492,55 @@ enum {
     kParam_SmoothAtten,
     kParam_ShiftAtten,
     
+    // Mode (Page 3), added after the original parameter set
+    kParam_Engine,
+    kParam_ControlRate,
+    
+    // Inputs (Page 1), added after the original parameter set
+    kParam_ClockInput,
+    
+    // Master/slave phase (Tides 2 engine): Ramp In on page 1, Phase Out on page 2
+    kParam_RampInput,
+    kParam_PhaseOutput,
+    kParam_PhaseOutputMode,
+    
+    // Mode (Page 3): Classic engine polyBLEP
+    kParam_AntiAliasing,
+    
+    // Voices page: MIDI notes play the voices
+    kParam_MidiChannel,
+    
     kNumParams
 };
 
-static const char* rampModeNames[] = { "AD", "Cycle", "AR", NULL };
-static const char* rangeNames[] = { "Low", "Medium", "High", NULL };
-static const char* outputModeNames[] = { "Gates", "Amplitude", "Slope/Phase", "Frequency", NULL };
+// Per-voice parameters, appended after kNumParams for each extra voice
+enum {
+    kVoiceParam_Trig,
+    kVoiceParam_VOct,
+    kVoiceParam_Output,
+    kVoiceParam_OutputMode,
+    
+    kNumVoiceParams
+};
+
+enum {
+    kSpec_Voices,
+    kSpec_RowCache,
+    
+    kNumSpecs
+};
+
+static const _NT_specification specifications[] = {
+    { .name = "Voices", .min = 0, .max = MAX_VOICES, .def = 0, .type = kNT_typeGeneric },
+    { .name = "Row cache", .min = 0, .max = 1, .def = 1, .type = kNT_typeGeneric },
+};
+
+static const char* const rampModeNames[] = { "AD", "Cycle", "AR", NULL };
+static const char* const rangeNames[] = { "Low", "Medium", "High", NULL };
+static const char* const outputModeNames[] = { "Gates", "Amplitude", "Slope/Phase", "Frequency", NULL };
+static const char* const engineNames[] = { "Classic", "Tides 2", NULL };
+static const char* const offOnNames[] = { "Off", "On", NULL };
+static const char* const antiAliasingNames[] = { "Off", "Auto", "On", NULL };
 
 static const _NT_parameter parameters[] = {
     // Inputs - page 1
@@ -168,19 +581,40 @@ static const _NT_parameter parameters[] = {
     { .name = "Slope Atten", .min = -100, .max = 100, .def = 100, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL },
     { .name = "Smooth Atten", .min = -100, .max = 100, .def = 100, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL },
     { .name = "Shift Atten", .min = -100, .max = 100, .def = 100, .unit = kNT_unitPercent, .scaling = 0, .enumStrings = NULL },
+    
+    // Engine - page 3
+    { .name = "Engine", .min = 0, .max = 1, .def = ENGINE_CLASSIC, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = engineNames },
+    // Classic engine: compute every CONTROL_RATE_DECIMATION samples at low pitches
+    { .name = "Control Rate", .min = 0, .max = 1, .def = 0, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = offOnNames },
+    
+    // Clock In - page 1: frequency follows the clock, Frequency picks the ratio
+    NT_PARAMETER_CV_INPUT("Clock In", 0, 0)
+    
+    // Tides 2 engine only: follow an external 0-8V ramp, and export this ramp.
+    // The classic engine leaves both alone, and draw() says so.
+    NT_PARAMETER_CV_INPUT("Ramp In", 0, 0)
+    NT_PARAMETER_CV_OUTPUT_WITH_MODE("Phase Out", 0, 0)
+    
+    // Classic engine, Cycle mode: band-limited slope and gates per block
+    { .name = "Anti-Aliasing", .min = 0, .max = 2, .def = ANTI_ALIAS_AUTO, .unit = kNT_unitEnum, .scaling = 0, .enumStrings = antiAliasingNames },
+    
+    // Voices - 0 = off, else note on/off on this channel gate and pitch them
+    { .name = "MIDI Channel", .min = 0, .max = 16, .def = 0, .unit = kNT_unitNone, .scaling = 0, .enumStrings = NULL },
 };
 
 // Page definitions
 static const uint8_t pageInputs[] = { 
-    kParam_TrigInput, kParam_VOctInput, kParam_FMInput, 
+    kParam_TrigInput, kParam_ClockInput, kParam_RampInput, kParam_VOctInput, kParam_FMInput, 
     kParam_ShapeInput, kParam_SlopeInput, kParam_SmoothInput, kParam_ShiftInput 
 };
 static const uint8_t pageOutputs[] = {
     kParam_Output1, kParam_Output1Mode, kParam_Output2, kParam_Output2Mode,
-    kParam_Output3, kParam_Output3Mode, kParam_Output4, kParam_Output4Mode
+    kParam_Output3, kParam_Output3Mode, kParam_Output4, kParam_Output4Mode,
+    kParam_PhaseOutput, kParam_PhaseOutputMode
 };
 static const uint8_t pageMode[] = {
-    kParam_RampMode, kParam_Range, kParam_OutputMode
+    kParam_RampMode, kParam_Range, kParam_OutputMode, kParam_Engine, kParam_ControlRate,
+    kParam_AntiAliasing
 };
 static const uint8_t pageMain[] = {
     kParam_Frequency, kParam_Shape, kParam_Slope, kParam_Smoothness, kParam_Shift
@@ -197,28 +631,319 @@ static const _NT_parameterPage pages[] = {
     { .name = "Modulation", .numParams = sizeof(pageMod), .params = pageMod },
 };
 
+static constexpr int NUM_PAGES = sizeof(pages) / sizeof(pages[0]);
+
 static const _NT_parameterPages parameterPages = {
-    .numPages = sizeof(pages) / sizeof(pages[0]),
+    .numPages = NUM_PAGES,
     .pages = pages,
 };
 
+static const char* const voiceParamNames[MAX_VOICES][kNumVoiceParams] = {
+    { "Voice 1 Trig", "Voice 1 V/Oct", "Voice 1 Out", "Voice 1 Out mode" },
+    { "Voice 2 Trig", "Voice 2 V/Oct", "Voice 2 Out", "Voice 2 Out mode" },
+    { "Voice 3 Trig", "Voice 3 V/Oct", "Voice 3 Out", "Voice 3 Out mode" },
+    { "Voice 4 Trig", "Voice 4 V/Oct", "Voice 4 Out", "Voice 4 Out mode" },
+    { "Voice 5 Trig", "Voice 5 V/Oct", "Voice 5 Out", "Voice 5 Out mode" },
+    { "Voice 6 Trig", "Voice 6 V/Oct", "Voice 6 Out", "Voice 6 Out mode" },
+    { "Voice 7 Trig", "Voice 7 V/Oct", "Voice 7 Out", "Voice 7 Out mode" },
+    { "Voice 8 Trig", "Voice 8 V/Oct", "Voice 8 Out", "Voice 8 Out mode" },
+};
+
+// One voice's parameters, named per voice by buildParameterTables()
+static const _NT_parameter voiceParameters[] = {
+    NT_PARAMETER_CV_INPUT("Trig", 0, 0)
+    NT_PARAMETER_CV_INPUT("V/Oct", 0, 0)
+    NT_PARAMETER_CV_OUTPUT_WITH_MODE("Out", 0, 0)
+};
+static_assert(sizeof(voiceParameters) / sizeof(voiceParameters[0]) == kNumVoiceParams,
+              "one entry per voice parameter");
+
+// Parameter and page tables for instances with extra voices
+struct TidesParameterTables {
+    _NT_parameter parameters[kNumParams + MAX_VOICES * kNumVoiceParams];
+    _NT_parameterPage pages[NUM_PAGES + 1];
+    uint8_t pageVoices[1 + MAX_VOICES * kNumVoiceParams];
+    _NT_parameterPages parameterPages;
+};
+
+static int voiceParam(int voice, int param) {
+    return kNumParams + voice * kNumVoiceParams + param;
+}
+
+static void buildParameterTables(TidesParameterTables& tables, int numVoices) {
+    memcpy(tables.parameters, parameters, sizeof(parameters));
+    memcpy(tables.pages, pages, sizeof(pages));
+    
+    for (int voice = 0; voice < numVoices; ++voice) {
+        const char* const* names = voiceParamNames[voice];
+        _NT_parameter* p = &tables.parameters[voiceParam(voice, 0)];
+        for (int i = 0; i < kNumVoiceParams; ++i) {
+            p[i] = voiceParameters[i];
+            p[i].name = names[i];
+            tables.pageVoices[1 + voice * kNumVoiceParams + i] = voiceParam(voice, i);
+        }
+    }
+    tables.pageVoices[0] = kParam_MidiChannel;
+    
+    tables.pages[NUM_PAGES] = { .name = "Voices", .numParams = (uint8_t)(1 + numVoices * kNumVoiceParams), .params = tables.pageVoices };
+    tables.parameterPages.numPages = NUM_PAGES + 1;
+    tables.parameterPages.pages = tables.pages;
+}
+
+// ============================================================================
+// Render Configuration
+// ============================================================================
+
+// CV inputs, in the order of their parameters from kParam_TrigInput
+enum {
+    kInput_Trig,
+    kInput_VOct,
+    kInput_FM,
+    kInput_Shape,
+    kInput_Slope,
+    kInput_Smooth,
+    kInput_Shift,
+    
+    kNumInputs
+};
+
+// Everything step() needs from the parameters, kept up to date by
+// parameterChanged() so a block only has to resolve bus pointers
+struct RenderConfig {
+    RampMode rampMode;
+    FreqRange range;
+    OutputMode outputMode;
+    int engine;
+    bool controlRate;
+    AntiAliasing antiAliasing;
+    
+    int frequencySemitones;
+    float frequency;        // Hz: range base frequency and Frequency offset
+    
+    // Normalized main parameters (0-1)
+    float shape;
+    float slope;
+    float smoothness;
+    float shift;
+    
+    // Attenuverters (-1 to 1), FM as semitones per volt
+    float fmAtten;
+    float fmSemitones;
+    float shapeAtten;
+    float slopeAtten;
+    float smoothAtten;
+    float shiftAtten;
+    
+    // Attenuverters as parameter change per volt, for the voices
+    float shapeScale;
+    float slopeScale;
+    float smoothScale;
+    
+    // Routing: bus numbers (0 = none)
+    int inputBus[kNumInputs];
+    int clockBus;
+    const tides::Ratio* clockRatio;     // From Frequency while clocked
+    int rampBus;
+    int phaseBus;
+    bool phaseReplace;
+    int outputBus[4];
+    bool replace[4];
+    uint8_t patched[4];         // Patched outputs, in order
+    int numPatched;
+    int scopeFramesPerColumn;   // From Range
+    int scopeStride;            // Frames between scope samples
+    int activeChannels;         // Last patched output, at least 1
+    bool pitchPatched;          // V/Oct or FM
+    bool modPatched;            // Any of Shape, Slope, Smooth and Shift
+    
+    int voiceTrigBus[MAX_VOICES];
+    int voiceVOctBus[MAX_VOICES];
+    int voiceOutputBus[MAX_VOICES];
+    bool voiceReplace[MAX_VOICES];
+    int midiChannel;                    // 0 = voices follow their CV inputs
+};
+
+// Bus block for a bus number, or nullptr when unpatched
+static inline float* busBlock(float* busFrames, int bus, int numFrames) {
+    return bus > 0 ? busFrames + (bus - 1) * numFrames : nullptr;
+}
+
+// ============================================================================
+// Algorithm Structure
+// ============================================================================
+
+struct _TidesAlgorithm : public _NT_algorithm {
+    _TidesAlgorithm(_TidesDTC* dtc_) : dtc(dtc_) {}
+    ~_TidesAlgorithm() {}
+    
+    _TidesDTC* dtc;
+    tides::PolySlopeGenerator* poly;    // Tides 2 engine, after the algorithm in SRAM
+    const float* zero_block;            // maxFramesPerStep zeros, in DTC
+    float* sink_block;                  // Output for unrouted channels, in DTC
+    float* sync_block;                  // Clock phase sync pulses, in DTC
+    uint16_t* gate_edges;               // Gate changes in the block, in DTC
+    float* cv_block;                    // CV_LANE_COUNT conditioned CV blocks, per-block scratch
+    float* channel_block;               // The engine's 4 channels before output, after them
+    float inv_sample_rate;
+    
+    // Clock In, kept across engine changes
+    ClockTracker clock;
+    float block_frequency;              // Frequency for this block, Hz
+    bool clock_sync;                    // Trig/Gate replaced by sync_block
+    
+    RenderConfig config;
+    
+    // Engine the DSP state was last initialised for
+    int active_engine;
+    bool poly_gate_high;
+    float poly_ramp;                    // Last Ramp In sample, 0-1
+    float poly_ramp_frequency;          // Its last increment per frame
+    
+    // Extra voices, and their parameter tables (in SRAM after this struct)
+    _TidesVoices voices;
+    VoiceAllocator midi;
+    TidesParameterTables* tables;
+    
+    TidesScope scope;
+    
+#ifdef TIDES_ITCM
+    ItcmCache itcm;
+#endif
+    
+#ifdef TIDES_PROFILE
+    TidesProfile profile;
+#endif
+};
+
 // ============================================================================
 // DSP Helper Functions
 // ============================================================================
 
-// Convert semitones to frequency ratio
+// Convert semitones to frequency ratio (block-rate; per-sample pitch uses
+// tides::SemitonesToRatio)
 static inline float semitonesToRatio(float semitones) {
     return expf(semitones * 0.0577622650f);  // ln(2)/12
 }
 
+// True if every sample of a bus block is within tolerance of the first
+static inline bool isBlockConstant(const float* in, int numFrames, float tolerance = 0.0f) {
+    const float first = in[0];
+    for (int i = 1; i < numFrames; ++i) {
+        if (fabsf(in[i] - first) > tolerance) return false;
+    }
+    return true;
+}
+
+// Gate pre-scan: the frames of a block where the gate (above ~1V) changes
+// level; high holds the level before the block and is left at its end
+static inline int scanGateEdges(const float* trig, int numFrames, bool& high, uint16_t* edges) {
+    int count = 0;
+    bool previous = high;
+    for (int i = 0; i < numFrames; ++i) {
+        const bool level = trig[i] > 1.0f;
+        edges[count] = (uint16_t)i;
+        count += level != previous;
+        previous = level;
+    }
+    high = previous;
+    return count;
+}
+
+// Gate pre-scan into one GateFlags per frame
+static inline void scanGateFlags(const float* trig, int numFrames, bool& high, tides::GateFlags* flags) {
+    bool previous = high;
+    for (int i = 0; i < numFrames; ++i) {
+        const bool level = trig[i] > 1.0f;
+        int f = level ? tides::GATE_FLAG_HIGH : tides::GATE_FLAG_LOW;
+        if (level && !previous) f |= tides::GATE_FLAG_RISING;
+        if (!level && previous) f |= tides::GATE_FLAG_FALLING;
+        flags[i] = (tides::GateFlags)f;
+        previous = level;
+    }
+    high = previous;
+}
+
+// Measure the clock period and write a 1-sample sync pulse every q rising
+// edges. A period within 1/8 of the tracked one is smoothed in; anything
+// else is taken as a tempo change and adopted immediately, so the tracker
+// locks on the second edge after a change.
+static void trackClock(ClockTracker& t, const float* clock, int numFrames, float* sync, int q, uint32_t timeout) {
+    memset(sync, 0, numFrames * sizeof(float));
+    uint32_t counter = t.counter;
+    bool previous = t.high;
+    for (int i = 0; i < numFrames; ++i) {
+        const bool level = clock[i] > 1.0f;
+        ++counter;
+        if (level && !previous) {
+            if (t.started) {
+                const uint32_t measured = counter << CLOCK_PERIOD_SHIFT;
+                const uint32_t tolerance = t.period >> 3;
+                if (t.period != 0 && measured + tolerance >= t.period && measured <= t.period + tolerance) {
+                    t.period = (3 * t.period + measured + 2) >> 2;
+                } else {
+                    t.period = measured;
+                }
+            }
+            t.started = true;
+            counter = 0;
+            if (++t.edges >= q) {
+                t.edges = 0;
+                sync[i] = 5.0f;
+            }
+        }
+        previous = level;
+    }
+    
+    // Clock stopped: keep the last tempo, but don't measure the gap
+    if (counter > timeout) {
+        t.started = false;
+        counter = 0;
+    }
+    t.counter = counter;
+    t.high = previous;
+}
+
+// Modulation CV that moves less than this over a block is treated as held
+static constexpr float MOD_CV_TOLERANCE = 0.001f;
+
 // Clamp value to range
 static inline float clamp(float x, float lo, float hi) {
     return x < lo ? lo : (x > hi ? hi : x);
 }
 
-// One-pole lowpass for parameter smoothing
+// Phase accumulators are 32-bit fixed point with 2^32 per cycle, so a
+// looping phase wraps by overflowing and keeps full resolution however slow
+// it runs. Envelopes stop at PHASE_END, which reads as 1.0.
+static constexpr float PHASE_SCALE = 4294967296.0f;
+static constexpr float PHASE_TO_FLOAT = 1.0f / PHASE_SCALE;
+static constexpr uint32_t PHASE_HALF = 0x80000000u;
+static constexpr uint32_t PHASE_END = 0xFFFFFFFFu;
+
+// Fixed-point increment for a fraction of a cycle; a cycle or more saturates
+static inline uint32_t phaseIncrement(float cycles) {
+    return cycles < 1.0f ? (uint32_t)(cycles * PHASE_SCALE) : PHASE_END;
+}
+
+// Advance a phase, stopping at limit (and at the end of the cycle)
+static inline uint32_t advancePhase(uint32_t phase, uint32_t increment, uint32_t limit) {
+    const uint32_t next = phase + increment;
+    return next < phase || next > limit ? limit : next;
+}
+
+// One-pole lowpass for parameter smoothing (about 5ms per sample)
+static constexpr float PARAM_SMOOTH_COEFF = 0.005f;
+
 static inline float smoothParam(float current, float target, float coeff) {
-    return current + coeff * (target - current);
+    const float next = current + coeff * (target - current);
+    // Land on the target instead of decaying into denormals, which would
+    // then be interpolated every sample
+    return fabsf(target - next) < 1.0e-6f ? target : next;
+}
+
+// Coefficient of the same one-pole applied over a whole block, so it can
+// be stepped once per block and interpolated linearly in between
+static inline float blockSmoothCoeff(int numFrames) {
+    return 1.0f - powf(1.0f - PARAM_SMOOTH_COEFF, (float)numFrames);
 }
 
 // Apply asymmetric slope to a ramp (0-1 input → 0-1 output with variable rise/fall)
@@ -256,12 +981,15 @@ static inline float applyShape(float x, float shape) {
     }
 }
 
-// Apply smoothness: <50% = lowpass filter, >50% = wavefold
-static inline float applySmoothness(float x, float smoothness, float& lpState) {
+// Apply smoothness: <50% = lowpass filter, >50% = wavefold. The lowpass
+// runs once per span samples, with the coefficient of span steps of the
+// per-sample one-pole.
+static inline float applySmoothness(float x, float smoothness, float& lpState, float span = 1.0f) {
     if (smoothness < 0.5f) {
         // Lowpass filtering
         float cutoff = smoothness * 2.0f;  // 0 = no filtering, 1 = full filtering
         float coeff = 0.01f + cutoff * 0.49f;  // Smoothing coefficient
+        if (span != 1.0f) coeff = 1.0f - powf(1.0f - coeff, span);
         lpState = lpState + coeff * (x - lpState);
         return lpState;
     } else {
@@ -272,403 +1000,1687 @@ static inline float applySmoothness(float x, float smoothness, float& lpState) {
         // Simple triangle wavefolder
         if (foldAmount > 0.0f) {
             float gain = 1.0f + foldAmount * 3.0f;  // Amplify before folding
-            folded = x * gain;
             
-            // Fold the signal
-            while (folded > 1.0f || folded < -1.0f) {
-                if (folded > 1.0f) folded = 2.0f - folded;
-                if (folded < -1.0f) folded = -2.0f - folded;
-            }
+            // Fold the signal: the reflections at +/-1 form a triangle wave
+            // with period 4, evaluated directly so the cost is fixed
+            float t = x * gain + 1.0f;
+            t -= 4.0f * floorf(t * 0.25f);
+            folded = 1.0f - fabsf(t - 2.0f);
         }
         
         return folded;
     }
 }
 
+// ============================================================================
+// Output Stage
+// ============================================================================
+
+// Each patched output's channel goes to its bus in one sequential pass,
+// copied or added as its mode says, so the sample loop only stores to the
+// channel lanes and every bus is written as a single stream
+static void writeOutputs(const RenderConfig& c, float* const* channels, float* busFrames, int numFrames) {
+    for (int ch = 0; ch < 4; ++ch) {
+        float* __restrict bus = busBlock(busFrames, c.outputBus[ch], numFrames);
+        if (!bus) continue;
+        const float* __restrict src = channels[ch];
+        if (c.replace[ch]) {
+            memcpy(bus, src, numFrames * sizeof(float));
+        } else {
+            for (int i = 0; i < numFrames; ++i) bus[i] += src[i];
+        }
+    }
+}
+
 // ============================================================================
 // Plugin Callbacks
 // ============================================================================
 
-void calculateRequirements(_NT_algorithmRequirements& req, const int32_t* /* specifications */) {
-    req.numParameters = kNumParams;
-    req.sram = sizeof(_TidesAlgorithm);
+static constexpr size_t alignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) & ~(alignment - 1);
+}
+
+// Conditioned CV in cv_block, one block per lane: pitch in semitones, then
+// the modulation offsets with their attenuverters applied
+enum CvLane { CV_PITCH, CV_SHAPE, CV_SLOPE, CV_SMOOTH, CV_SHIFT, CV_LANE_COUNT };
+
+// Per-block scratch: the classic engine's CV lanes, then the four channels
+// either engine renders before the output stage. Nothing in it outlives a step(), so it
+// is the shared NT_globals.workBuffer, unless that is too small.
+static size_t scratchBytes() {
+    return (CV_LANE_COUNT + 4) * NT_globals.maxFramesPerStep * sizeof(float);
+}
+
+static bool scratchInWorkBuffer() {
+    return NT_globals.workBuffer && NT_globals.workBufferSizeBytes >= scratchBytes();
+}
+
+// DTC layout: per-sample state, the Tides 2 engine's cached wavetable rows
+// if the Row cache specification is on, the zero, sink and sync blocks and
+// gate edges used by the classic kernels, the scratch if it is not in the
+// work buffer, then the voice arrays. Each region starts on a cache line.
+struct DtcLayout {
+    size_t shape_cache;
+    size_t zero_block;
+    size_t sink_block;
+    size_t sync_block;
+    size_t gate_edges;
+    size_t scratch;
+    size_t voice_phase;
+    size_t voice_lp_state;
+    size_t voice_phase_inc;
+    size_t voice_gate_high;
+    size_t voice_envelope_running;
+    size_t size;
+};
+
+static DtcLayout dtcLayout(int numVoices, bool rowCache) {
+    const size_t line = DTC_CACHE_LINE;
+    const size_t blockBytes = alignUp(NT_globals.maxFramesPerStep * sizeof(float), line);
+    const size_t voiceWords = alignUp(numVoices * sizeof(uint32_t), line);    // 32-bit entries
+    const size_t voiceFlags = alignUp(numVoices, line);
+    DtcLayout layout;
+    layout.shape_cache = alignUp(sizeof(_TidesDTC), line);
+    layout.zero_block = layout.shape_cache + (rowCache ? alignUp(sizeof(tides::ShapeRowCache), line) : 0);
+    layout.sink_block = layout.zero_block + blockBytes;
+    layout.sync_block = layout.sink_block + blockBytes;
+    layout.gate_edges = layout.sync_block + blockBytes;
+    layout.scratch = layout.gate_edges + alignUp(NT_globals.maxFramesPerStep * sizeof(uint16_t), line);
+    layout.voice_phase = layout.scratch + (scratchInWorkBuffer() ? 0 : alignUp(scratchBytes(), line));
+    layout.voice_lp_state = layout.voice_phase + voiceWords;
+    layout.voice_phase_inc = layout.voice_lp_state + voiceWords;
+    layout.voice_gate_high = layout.voice_phase_inc + voiceWords;
+    layout.voice_envelope_running = layout.voice_gate_high + voiceFlags;
+    layout.size = layout.voice_envelope_running + voiceFlags;
+    return layout;
+}
+
+static int numVoicesFromSpecifications(const int32_t* specifications) {
+    const int voices = specifications ? specifications[kSpec_Voices] : 0;
+    return voices < 0 ? 0 : (voices > MAX_VOICES ? MAX_VOICES : voices);
+}
+
+static bool rowCacheFromSpecifications(const int32_t* specifications) {
+    return specifications ? specifications[kSpec_RowCache] != 0 : true;
+}
+
+// SRAM layout: the algorithm, its parameter tables if it has voices, then
+// the Tides 2 engine. It is only used when Tides 2 is selected, which can
+// change at any time, so it stays out of the DTC every instance of the
+// classic engine would otherwise pay for.
+struct SramLayout {
+    size_t tables;
+    size_t poly;
+    size_t size;
+};
+
+static SramLayout sramLayout(int numVoices) {
+    SramLayout layout;
+    layout.tables = alignUp(sizeof(_TidesAlgorithm), alignof(TidesParameterTables));
+    const size_t tablesEnd = numVoices > 0 ? layout.tables + sizeof(TidesParameterTables) : sizeof(_TidesAlgorithm);
+    layout.poly = alignUp(tablesEnd, alignof(tides::PolySlopeGenerator));
+    layout.size = layout.poly + sizeof(tides::PolySlopeGenerator);
+    return layout;
+}
+
+// Plugin-wide tables in DRAM, built once by initialise() and shared by
+// every instance
+static const tides::SharedTables* sharedTables = nullptr;
+
+void calculateStaticRequirements(_NT_staticRequirements& req) {
+    req.dram = sizeof(tides::SharedTables);
+}
+
+void initialise(_NT_staticMemoryPtrs& ptrs, const _NT_staticRequirements& /* req */) {
+    tides::SharedTables* tables = new (ptrs.dram) tides::SharedTables();
+    tables->Init();
+    sharedTables = tables;
+}
+
+void calculateRequirements(_NT_algorithmRequirements& req, const int32_t* specifications) {
+    const int numVoices = numVoicesFromSpecifications(specifications);
+    req.numParameters = kNumParams + numVoices * kNumVoiceParams;
+    req.sram = sramLayout(numVoices).size;
     req.dram = 0;
-    req.dtc = sizeof(_TidesDTC);
+    // Includes the wavetable row cache if enabled (~8 KB of float rows, ~4 KB
+    // with Q15_SHAPE=1), plus slack so construct() can move the base up to a
+    // cache line
+    req.dtc = dtcLayout(numVoices, rowCacheFromSpecifications(specifications)).size + DTC_CACHE_LINE - 1;
+#ifdef TIDES_ITCM
+    req.itc = itcmSize(numVoices);
+#else
     req.itc = 0;
+#endif
 }
 
-_NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorithmRequirements& /* req */, const int32_t* /* specifications */) {
-    _TidesDTC* dtc = (_TidesDTC*)ptrs.dtc;
-    _TidesAlgorithm* alg = new (ptrs.sram) _TidesAlgorithm(dtc);
-    
-    alg->parameters = parameters;
-    alg->parameterPages = &parameterPages;
-    alg->inv_sample_rate = 1.0f / NT_globals.sampleRate;
-    
-    // Initialize DTC
-    memset(dtc, 0, sizeof(_TidesDTC));
+// Reset the classic engine's state
+static void initClassic(_TidesDTC* dtc) {
+    *dtc = _TidesDTC();
     dtc->smooth_shape = 0.5f;
     dtc->smooth_slope = 0.5f;
     dtc->smooth_smoothness = 0.5f;
     dtc->smooth_shift = 0.5f;
-    
-    return alg;
+    for (int ch = 0; ch < 4; ++ch) {
+        dtc->ratio[ch] = { 1.0f, 1 };
+        dtc->channel_phase[ch] = PHASE_END;
+        dtc->shaper[ch].Init();
+    }
+    dtc->channel_ramp_mode = -1;
+    dtc->ratio_quantizer.Init(21, 0.05f, false);
 }
 
-void parameterChanged(_NT_algorithm* /* self */, int /* p */) {
-    // Parameters are read directly in step(), smoothing applied there
+// Start an empty column
+static void resetScopeColumn(TidesScope& scope) {
+    for (int ch = 0; ch < 4; ++ch) {
+        scope.pending_min[ch] = 1e9f;
+        scope.pending_max[ch] = -1e9f;
+    }
+    scope.pending_frames = 0;
 }
 
-void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
-    _TidesAlgorithm* alg = (_TidesAlgorithm*)self;
-    _TidesDTC* dtc = alg->dtc;
-    int numFrames = numFramesBy4 * 4;
-    
-    // === Read parameters ===
-    const RampMode rampMode = (RampMode)alg->v[kParam_RampMode];
-    const FreqRange range = (FreqRange)alg->v[kParam_Range];
-    const OutputMode outputMode = (OutputMode)alg->v[kParam_OutputMode];
-    
-    // Get base frequency for current range
-    float baseFreq;
+// Reset the extra voices
+static void initVoices(_TidesVoices& voices) {
+    for (int v = 0; v < voices.count; ++v) {
+        voices.phase[v] = 0;
+        voices.lp_state[v] = 0.0f;
+        voices.phase_inc[v] = 0.0f;
+        voices.gate_high[v] = 0;
+        voices.envelope_running[v] = 0;
+    }
+    voices.smooth_shape = 0.5f;
+    voices.smooth_slope = 0.5f;
+    voices.smooth_smoothness = 0.5f;
+}
+
+// Release every voice and restart the round robin at voice 1
+static void initVoiceAllocator(VoiceAllocator& a) {
+    memset(&a, 0, sizeof(a));
+    a.last = -1;
+}
+
+// Get base frequency for a range
+static inline float rangeBaseFrequency(FreqRange range) {
     switch (range) {
-        case RANGE_LOW:    baseFreq = FREQ_LOW; break;
-        case RANGE_MEDIUM: baseFreq = FREQ_MEDIUM; break;
-        case RANGE_HIGH:   baseFreq = FREQ_HIGH; break;
-        default:           baseFreq = FREQ_MEDIUM; break;
+        case RANGE_LOW:    return FREQ_LOW;
+        case RANGE_MEDIUM: return FREQ_MEDIUM;
+        case RANGE_HIGH:   return FREQ_HIGH;
+        default:           return FREQ_MEDIUM;
+    }
+}
+
+// Fold one parameter value into the render configuration
+static void updateConfig(RenderConfig& c, int p, int value) {
+    if (p >= kNumParams) {
+        const int voice = (p - kNumParams) / kNumVoiceParams;
+        switch ((p - kNumParams) % kNumVoiceParams) {
+            case kVoiceParam_Trig:       c.voiceTrigBus[voice] = value; break;
+            case kVoiceParam_VOct:       c.voiceVOctBus[voice] = value; break;
+            case kVoiceParam_Output:     c.voiceOutputBus[voice] = value; break;
+            case kVoiceParam_OutputMode: c.voiceReplace[voice] = value; break;
+        }
+        return;
     }
     
-    // Frequency with semitone offset
-    float freqSemitones = (float)alg->v[kParam_Frequency];
-    float frequency = baseFreq * semitonesToRatio(freqSemitones);
-    
-    // Normalized parameters (0-1)
-    float targetShape = alg->v[kParam_Shape] / 100.0f;
-    float targetSlope = alg->v[kParam_Slope] / 100.0f;
-    float targetSmoothness = alg->v[kParam_Smoothness] / 100.0f;
-    float targetShift = alg->v[kParam_Shift] / 100.0f;
-    
-    // Attenuverters
-    float fmAtten = alg->v[kParam_FMAmount] / 100.0f;
-    float shapeAtten = alg->v[kParam_ShapeAtten] / 100.0f;
-    float slopeAtten = alg->v[kParam_SlopeAtten] / 100.0f;
-    float smoothAtten = alg->v[kParam_SmoothAtten] / 100.0f;
-    float shiftAtten = alg->v[kParam_ShiftAtten] / 100.0f;
-    
-    // === Get CV inputs ===
-    const int trigBus = alg->v[kParam_TrigInput];
-    const int voctBus = alg->v[kParam_VOctInput];
-    const int fmBus = alg->v[kParam_FMInput];
-    const int shapeBus = alg->v[kParam_ShapeInput];
-    const int slopeBus = alg->v[kParam_SlopeInput];
-    const int smoothBus = alg->v[kParam_SmoothInput];
-    const int shiftBus = alg->v[kParam_ShiftInput];
-    
-    const float* trigIn = (trigBus > 0) ? busFrames + (trigBus - 1) * numFrames : nullptr;
-    const float* voctIn = (voctBus > 0) ? busFrames + (voctBus - 1) * numFrames : nullptr;
-    const float* fmIn = (fmBus > 0) ? busFrames + (fmBus - 1) * numFrames : nullptr;
-    const float* shapeIn = (shapeBus > 0) ? busFrames + (shapeBus - 1) * numFrames : nullptr;
-    const float* slopeIn = (slopeBus > 0) ? busFrames + (slopeBus - 1) * numFrames : nullptr;
-    const float* smoothIn = (smoothBus > 0) ? busFrames + (smoothBus - 1) * numFrames : nullptr;
-    const float* shiftIn = (shiftBus > 0) ? busFrames + (shiftBus - 1) * numFrames : nullptr;
-    
-    // === Get output buses ===
-    const int out1Bus = alg->v[kParam_Output1];
-    const int out2Bus = alg->v[kParam_Output2];
-    const int out3Bus = alg->v[kParam_Output3];
-    const int out4Bus = alg->v[kParam_Output4];
-    
-    float* out1 = (out1Bus > 0) ? busFrames + (out1Bus - 1) * numFrames : nullptr;
-    float* out2 = (out2Bus > 0) ? busFrames + (out2Bus - 1) * numFrames : nullptr;
-    float* out3 = (out3Bus > 0) ? busFrames + (out3Bus - 1) * numFrames : nullptr;
-    float* out4 = (out4Bus > 0) ? busFrames + (out4Bus - 1) * numFrames : nullptr;
-    
-    const bool out1Replace = alg->v[kParam_Output1Mode];
-    const bool out2Replace = alg->v[kParam_Output2Mode];
-    const bool out3Replace = alg->v[kParam_Output3Mode];
-    const bool out4Replace = alg->v[kParam_Output4Mode];
-    
-    // Smoothing coefficient (about 5ms)
-    const float smoothCoeff = 0.005f;
-    
-    // Lowpass state for smoothness processing
-    static float lpState[4] = {0, 0, 0, 0};
+    if (p >= kParam_TrigInput && p <= kParam_ShiftInput) {
+        c.inputBus[p - kParam_TrigInput] = value;
+        c.pitchPatched = c.inputBus[kInput_VOct] > 0 || c.inputBus[kInput_FM] > 0;
+        c.modPatched = c.inputBus[kInput_Shape] > 0 || c.inputBus[kInput_Slope] > 0 ||
+            c.inputBus[kInput_Smooth] > 0 || c.inputBus[kInput_Shift] > 0;
+        return;
+    }
+    
+    if (p >= kParam_Output1 && p <= kParam_Output4Mode) {
+        const int ch = (p - kParam_Output1) / 2;
+        if ((p - kParam_Output1) % 2) {
+            c.replace[ch] = value;
+            return;
+        }
+        c.outputBus[ch] = value;
+        c.numPatched = 0;
+        c.activeChannels = 1;
+        for (int i = 0; i < 4; ++i) {
+            if (c.outputBus[i] > 0) {
+                c.patched[c.numPatched++] = (uint8_t)i;
+                c.activeChannels = i + 1;
+            }
+        }
+        return;
+    }
+    
+    switch (p) {
+        case kParam_RampMode:    c.rampMode = (RampMode)value; break;
+        case kParam_OutputMode:  c.outputMode = (OutputMode)value; break;
+        case kParam_Engine:      c.engine = value; break;
+        case kParam_ControlRate: c.controlRate = value; break;
+        case kParam_AntiAliasing: c.antiAliasing = (AntiAliasing)value; break;
+        case kParam_MidiChannel: c.midiChannel = value; break;
+        case kParam_Range:
+            c.range = (FreqRange)value;
+            c.scopeFramesPerColumn = (int)(SCOPE_WINDOW_SECONDS[c.range] * NT_globals.sampleRate / SCOPE_WIDTH);
+            c.scopeStride = c.scopeFramesPerColumn > SCOPE_POINTS_PER_COLUMN
+                ? c.scopeFramesPerColumn / SCOPE_POINTS_PER_COLUMN : 1;
+            c.frequency = rangeBaseFrequency(c.range) * semitonesToRatio((float)c.frequencySemitones);
+            break;
+        case kParam_Frequency:
+            c.frequencySemitones = value;
+            c.frequency = rangeBaseFrequency(c.range) * semitonesToRatio((float)c.frequencySemitones);
+            // One clock ratio per 6 semitones, 1:1 at 0
+            c.clockRatio = &tides::clock_ratio_table[(value + 63) / 6];
+            break;
+        case kParam_ClockInput:  c.clockBus = value; break;
+        case kParam_RampInput:   c.rampBus = value; break;
+        case kParam_PhaseOutput: c.phaseBus = value; break;
+        case kParam_PhaseOutputMode: c.phaseReplace = value; break;
+        case kParam_Shape:       c.shape = value / 100.0f; break;
+        case kParam_Slope:       c.slope = value / 100.0f; break;
+        case kParam_Smoothness:  c.smoothness = value / 100.0f; break;
+        case kParam_Shift:       c.shift = value / 100.0f; break;
+        case kParam_FMAmount:
+            c.fmAtten = value / 100.0f;
+            c.fmSemitones = value / 100.0f * 12.0f;
+            break;
+        case kParam_ShapeAtten:
+            c.shapeAtten = value / 100.0f;
+            c.shapeScale = value * 0.001f;
+            break;
+        case kParam_SlopeAtten:
+            c.slopeAtten = value / 100.0f;
+            c.slopeScale = value * 0.001f;
+            break;
+        case kParam_SmoothAtten:
+            c.smoothAtten = value / 100.0f;
+            c.smoothScale = value * 0.001f;
+            break;
+        case kParam_ShiftAtten:  c.shiftAtten = value / 100.0f; break;
+    }
+}
+
+_NT_algorithm* construct(const _NT_algorithmMemoryPtrs& ptrs, const _NT_algorithmRequirements& /* req */, const int32_t* specifications) {
+    const int numVoices = numVoicesFromSpecifications(specifications);
+    uint8_t* dtcBase = (uint8_t*)alignUp((uintptr_t)ptrs.dtc, DTC_CACHE_LINE);
+    _TidesDTC* dtc = (_TidesDTC*)dtcBase;
+    _TidesAlgorithm* alg = new (ptrs.sram) _TidesAlgorithm(dtc);
+    const SramLayout sram = sramLayout(numVoices);
+    
+    if (numVoices > 0) {
+        alg->tables = (TidesParameterTables*)(ptrs.sram + sram.tables);
+        buildParameterTables(*alg->tables, numVoices);
+        alg->parameters = alg->tables->parameters;
+        alg->parameterPages = &alg->tables->parameterPages;
+    } else {
+        alg->tables = nullptr;
+        alg->parameters = parameters;
+        alg->parameterPages = &parameterPages;
+    }
+    alg->inv_sample_rate = 1.0f / NT_globals.sampleRate;
+    
+    // Defaults until the host reports the real values via parameterChanged()
+    memset(&alg->config, 0, sizeof(alg->config));
+    for (int p = 0; p < kNumParams + numVoices * kNumVoiceParams; ++p) {
+        updateConfig(alg->config, p, alg->parameters[p].def);
+    }
+    
+    // Initialize DTC
+    const bool rowCache = rowCacheFromSpecifications(specifications);
+    const DtcLayout layout = dtcLayout(numVoices, rowCache);
+    initClassic(dtc);
+    alg->poly = new (ptrs.sram + sram.poly) tides::PolySlopeGenerator();
+    alg->poly->set_wavetable(sharedTables->wavetable());
+    if (rowCache) {
+        alg->poly->set_shape_cache(new (dtcBase + layout.shape_cache) tides::ShapeRowCache());
+    }
+    alg->zero_block = (const float*)(dtcBase + layout.zero_block);
+    alg->sink_block = (float*)(dtcBase + layout.sink_block);
+    alg->sync_block = (float*)(dtcBase + layout.sync_block);
+    alg->gate_edges = (uint16_t*)(dtcBase + layout.gate_edges);
+    alg->cv_block = scratchInWorkBuffer() ? NT_globals.workBuffer : (float*)(dtcBase + layout.scratch);
+    alg->channel_block = alg->cv_block + CV_LANE_COUNT * NT_globals.maxFramesPerStep;
+    memset(dtcBase + layout.zero_block, 0, layout.size - layout.zero_block);
+    alg->poly->Init();
+    alg->active_engine = ENGINE_CLASSIC;
+    alg->poly_gate_high = false;
+    alg->poly_ramp = 0.0f;
+    alg->poly_ramp_frequency = 0.0f;
+    memset(&alg->clock, 0, sizeof(alg->clock));
+    alg->scope.written.store(0, std::memory_order_relaxed);
+    alg->scope.phase.store(0.0f, std::memory_order_relaxed);
+    resetScopeColumn(alg->scope);
+    alg->scope.next_point = 0;
+    
+    _TidesVoices& voices = alg->voices;
+    voices.count = numVoices;
+    voices.phase = (uint32_t*)(dtcBase + layout.voice_phase);
+    voices.lp_state = (float*)(dtcBase + layout.voice_lp_state);
+    voices.phase_inc = (float*)(dtcBase + layout.voice_phase_inc);
+    voices.gate_high = dtcBase + layout.voice_gate_high;
+    voices.envelope_running = dtcBase + layout.voice_envelope_running;
+    initVoices(voices);
+    initVoiceAllocator(alg->midi);
+    
+#ifdef TIDES_ITCM
+    initItcm(alg->itcm, ptrs.itc, numVoices);
+#endif
+    
+#ifdef TIDES_PROFILE
+    memset(&alg->profile, 0, sizeof(alg->profile));
+    resetProfileWindow(alg->profile);
+    enableCycleCounter();
+#endif
+    
+    return alg;
+}
+
+void parameterChanged(_NT_algorithm* self, int p) {
+    _TidesAlgorithm* alg = (_TidesAlgorithm*)self;
+    updateConfig(alg->config, p, alg->v[p]);
+    // Notes held on the old channel will not see their note off
+    if (p == kParam_MidiChannel) initVoiceAllocator(alg->midi);
+}
+
+// Ramp In to a 0-1 phase for each frame of a sub-block. Returns the phase
+// increment of its last frame, which stands in for the pitch CV: the master
+// reaches its target frequency there, so the slave is given the same one.
+// A step back is a wrap, unless it lands on zero or is too large for one,
+// which marks a reset of the master so ratio channels restart with it.
+static float scanRamp(const float* in, int size, float& previous, float& frequency,
+                      float* ramp, tides::GateFlags* flags) {
+    for (int i = 0; i < size; ++i) {
+        const float r = clamp(in[i] * (1.0f / PHASE_VOLTS), 0.0f, 1.0f);
+        float increment = r - previous;
+        bool reset = false;
+        if (increment < 0.0f) {
+            increment += 1.0f;
+            reset = r == 0.0f || increment > RAMP_IN_MAX_INCREMENT;
+        }
+        if (!reset) frequency = increment;
+        flags[i] = reset ? tides::GATE_FLAG_RISING : tides::GATE_FLAG_LOW;
+        previous = r;
+        ramp[i] = r;
+    }
+    return frequency;
+}
+
+// Tides 2 engine: converts the bus block into gate flags and renders it
+// through PolySlopeGenerator in sub-blocks of TIDES2_BLOCK_SIZE frames into
+// the channel lanes, like the classic engine, for the output stage.
+// With Ramp In patched the engine follows that ramp instead of its own
+// frequency (Trig/Gate is ignored); Phase Out carries the engine's phase.
+static void renderTides2(_TidesAlgorithm* alg, float* busFrames, int numFrames) {
+    static const tides::RampMode rampModes[] = {
+        tides::RAMP_MODE_AD, tides::RAMP_MODE_LOOPING, tides::RAMP_MODE_AR
+    };
+    static const tides::OutputMode outputModes[] = {
+        tides::OUTPUT_MODE_GATES, tides::OUTPUT_MODE_AMPLITUDE,
+        tides::OUTPUT_MODE_SLOPE_PHASE, tides::OUTPUT_MODE_FREQUENCY
+    };
+    
+    const RenderConfig& c = alg->config;
+    const tides::RampMode rampMode = rampModes[c.rampMode];
+    const tides::OutputMode outputMode = outputModes[c.outputMode];
+    const tides::Range polyRange = c.range == RANGE_HIGH ? tides::RANGE_AUDIO : tides::RANGE_CONTROL;
+    
+    const float baseFreq = alg->block_frequency * alg->inv_sample_rate;
+    
+    const float shape = c.shape;
+    const float slope = c.slope;
+    const float smoothness = c.smoothness;
+    const float shift = c.shift;
+    
+    const float fmAtten = c.fmAtten;
+    const float shapeAtten = c.shapeAtten;
+    const float slopeAtten = c.slopeAtten;
+    const float smoothAtten = c.smoothAtten;
+    const float shiftAtten = c.shiftAtten;
+    
+    const float* trigIn = alg->clock_sync ? alg->sync_block
+        : busBlock(busFrames, c.inputBus[kInput_Trig], numFrames);
+    const float* voctIn = busBlock(busFrames, c.inputBus[kInput_VOct], numFrames);
+    const float* fmIn = busBlock(busFrames, c.inputBus[kInput_FM], numFrames);
+    const float* shapeIn = busBlock(busFrames, c.inputBus[kInput_Shape], numFrames);
+    const float* slopeIn = busBlock(busFrames, c.inputBus[kInput_Slope], numFrames);
+    const float* smoothIn = busBlock(busFrames, c.inputBus[kInput_Smooth], numFrames);
+    const float* shiftIn = busBlock(busFrames, c.inputBus[kInput_Shift], numFrames);
+    const float* rampIn = busBlock(busFrames, c.rampBus, numFrames);
+    
+    float* out[4];
+    for (int ch = 0; ch < 4; ++ch) out[ch] = alg->channel_block + ch * NT_globals.maxFramesPerStep;
+    const size_t activeChannels = c.activeChannels;
+    float* phaseOut = busBlock(busFrames, c.phaseBus, numFrames);
+    
+    tides::GateFlags gateFlags[TIDES2_BLOCK_SIZE];
+    float ramp[TIDES2_BLOCK_SIZE];
+    float phase[TIDES2_BLOCK_SIZE];
+    tides::PolySlopeGenerator::OutputSample rendered[TIDES2_BLOCK_SIZE];
+    
+    for (int start = 0; start < numFrames; start += TIDES2_BLOCK_SIZE) {
+        const int size = numFrames - start < TIDES2_BLOCK_SIZE ? numFrames - start : TIDES2_BLOCK_SIZE;
+        
+        // Gate flags for each frame of the sub-block, and the frequency:
+        // CV is sampled once per sub-block; the engine interpolates
+        float frequency;
+        if (rampIn) {
+            frequency = scanRamp(rampIn + start, size, alg->poly_ramp, alg->poly_ramp_frequency,
+                                 ramp, gateFlags);
+        } else {
+            if (trigIn) {
+                scanGateFlags(trigIn + start, size, alg->poly_gate_high, gateFlags);
+            }
+            float pitch = 0.0f;
+            if (voctIn) pitch += voctIn[start] * 12.0f;
+            if (fmIn) pitch += fmIn[start] * 12.0f * fmAtten;
+            frequency = pitch != 0.0f ? baseFreq * tides::SemitonesToRatio(pitch) : baseFreq;
+        }
+        
+        float blockShape = shape;
+        float blockSlope = slope;
+        float blockSmoothness = smoothness;
+        float blockShift = shift;
+        if (shapeIn) blockShape = clamp(shape + shapeIn[start] * 0.1f * shapeAtten, 0.0f, 1.0f);
+        if (slopeIn) blockSlope = clamp(slope + slopeIn[start] * 0.1f * slopeAtten, 0.0f, 1.0f);
+        if (smoothIn) blockSmoothness = clamp(smoothness + smoothIn[start] * 0.1f * smoothAtten, 0.0f, 1.0f);
+        if (shiftIn) blockShift = clamp(shift + shiftIn[start] * 0.1f * shiftAtten, 0.0f, 1.0f);
+        
+        alg->poly->Render(rampMode, outputMode, polyRange,
+            frequency, blockSlope, blockShape, blockSmoothness, blockShift,
+            trigIn || rampIn ? gateFlags : nullptr, rampIn ? ramp : nullptr, rendered, size,
+            activeChannels, phaseOut ? phase : nullptr);
+        
+        for (int k = 0; k < c.numPatched; ++k) {
+            const int ch = c.patched[k];
+            float* dst = out[ch] + start;
+            for (int i = 0; i < size; ++i) dst[i] = rendered[i].channel[ch];
+        }
+        
+        // Phase Out, for another instance's Ramp In to follow
+        if (phaseOut) {
+            float* dst = phaseOut + start;
+            if (c.phaseReplace) {
+                for (int i = 0; i < size; ++i) dst[i] = phase[i] * PHASE_VOLTS;
+            } else {
+                for (int i = 0; i < size; ++i) dst[i] += phase[i] * PHASE_VOLTS;
+            }
+        }
+    }
+    
+    writeOutputs(c, out, busFrames, numFrames);
+}
+
+// ============================================================================
+// Classic Engine Kernels
+// ============================================================================
+
+// Routing bits: which groups of inputs a kernel reads
+enum {
+    ROUTE_TRIG = 1 << 0,    // Trig/Gate In
+    ROUTE_PITCH = 1 << 1,   // V/Oct In and/or FM In
+    ROUTE_MOD = 1 << 2,     // Any of Shape/Slope/Smooth/Shift In
+    ROUTE_COUNT = 1 << 3
+};
+
+// Everything a kernel needs, resolved once per block. Unrouted inputs in a
+// routed group read the zero block, and all four channels are written to
+// channel_block for the output stage, so the per-sample loop has no routing
+// branches.
+struct ClassicBlock {
+    // Gate level before the block, and the frames where it changes
+    bool gateAtStart;
+    const uint16_t* gateEdges;
+    int numGateEdges;
+    
+    // Conditioned CV from the CV stage, read when the group is routed
+    const float* pitchCv;   // Semitones
+    const float* shapeCv;
+    const float* slopeCv;
+    const float* smoothCv;
+    const float* shiftCv;
+    
+    float* out[4];          // Lanes of channel_block
+    
+    float frequency;
+    float targetShape;
+    float targetSlope;
+    float targetSmoothness;
+    float targetShift;
+    
+    // Patched outputs: the only channels the 4-channel modes compute. The
+    // other lanes are zeroed before the kernel runs.
+    const uint8_t* channels;
+    int numChannels;
+    
+    // Held modulation CV, already scaled, when ROUTE_MOD is clear
+    float shapeOffset;
+    float slopeOffset;
+    float smoothOffset;
+    float shiftOffset;
+    
+    // Samples covered by each computed frame: 1 at audio rate, the distance
+    // to the previous point at control rate
+    float span;
+    float invSampleRate;    // 1/sampleRate, times span
+    float smoothCoeff;      // Parameter smoothing over the whole call
+    
+    const tides::Ratio (*ratioTable)[4];    // Frequency mode ratios, by Range
+    
+    // Band-limited kernels only: the shapers were idle last block
+    bool fillShapers;
+};
+
+// Band-limited applySlope. The shaper's output is one sample late, so on
+// the first frame after the shapers were idle the naive value is used while
+// they take the current one.
+static inline float bandLimitedSlope(tides::RampShaper& shaper, float phase, float frequency, float slope, bool fill) {
+    const float ramp = shaper.BandLimitedSlope(phase, 0.0f, frequency, slope);
+    return fill ? applySlope(phase, slope) : ramp;
+}
+
+typedef void (*ClassicKernel)(_TidesAlgorithm* alg, const ClassicBlock& b, float* lpState, int numFrames);
+
+// Classic engine: everything is computed per sample, with the ramp mode,
+// output mode and input routing fixed at compile time. band_limited, for
+// Cycle mode only, runs the slopes and gates through dtc->shaper.
+template <RampMode ramp_mode, OutputMode output_mode, uint32_t routing, bool band_limited>
+TIDES_ITCM_INLINE static void classicKernel(_TidesAlgorithm* alg, const ClassicBlock& b, float* lpState, int numFrames) {
+    _TidesDTC* dtc = alg->dtc;
+    
+    const bool hasTrig = routing & ROUTE_TRIG;
+    const bool hasPitch = routing & ROUTE_PITCH;
+    const bool hasMod = routing & ROUTE_MOD;
+    static_assert(!band_limited || ramp_mode == RAMP_CYCLE, "band-limited kernels are Cycle mode only");
+    
+    // Whether the main phase wraps rather than stopping at the end
+    const bool looping = ramp_mode == RAMP_CYCLE || (ramp_mode == RAMP_AR && !hasTrig);
+    
+    // Parameters move to where the one-pole would be at the end of the
+    // call, in equal steps per sample
+    tides::ParameterInterpolator shapeSmoother(&dtc->smooth_shape,
+        smoothParam(dtc->smooth_shape, b.targetShape, b.smoothCoeff), numFrames);
+    tides::ParameterInterpolator slopeSmoother(&dtc->smooth_slope,
+        smoothParam(dtc->smooth_slope, b.targetSlope, b.smoothCoeff), numFrames);
+    tides::ParameterInterpolator smoothnessSmoother(&dtc->smooth_smoothness,
+        smoothParam(dtc->smooth_smoothness, b.targetSmoothness, b.smoothCoeff), numFrames);
+    const float endShift = smoothParam(dtc->smooth_shift, b.targetShift, b.smoothCoeff);
+    tides::ParameterInterpolator shiftSmoother(&dtc->smooth_shift, endShift, numFrames);
+    
+    // Frequency mode ratios, quantized once per call (a block, or a point at
+    // control rate) from the Shift it ends on, for the wraps and triggers in it
+    const tides::Ratio* nextRatio = nullptr;
+    if (output_mode == OUT_FREQUENCY) {
+        const float shift = clamp(endShift + (hasMod ? b.shiftCv[numFrames - 1] : b.shiftOffset), 0.0f, 1.0f);
+        nextRatio = b.ratioTable[dtc->ratio_quantizer.Process(shift)];
+    }
+    
+    float* const out1 = b.out[0];
+    float* const out2 = b.out[1];
+    float* const out3 = b.out[2];
+    float* const out4 = b.out[3];
+    
+    // Gate level, fixed between the edges found by the pre-scan
+    bool gate = hasTrig && b.gateAtStart;
+    int edge = 0;
+    int nextEdge = (hasTrig && b.numGateEdges > 0) ? b.gateEdges[0] : numFrames;
     
     // === Process each sample ===
     for (int i = 0; i < numFrames; ++i) {
         // --- Apply CV modulation ---
-        float cvFreq = frequency;
-        if (voctIn) {
-            // V/Oct: 5V = 1.0 in Disting NT = 5 octaves
-            cvFreq *= semitonesToRatio(voctIn[i] * 12.0f);
-        }
-        if (fmIn) {
-            cvFreq *= semitonesToRatio(fmIn[i] * 12.0f * fmAtten);
+        float cvFreq = b.frequency;
+        if (hasPitch) {
+            // V/Oct (1V per octave) and FM share one exponent
+            cvFreq *= tides::SemitonesToRatio(b.pitchCv[i]);
         }
         
         // Smooth and modulate other parameters
-        dtc->smooth_shape = smoothParam(dtc->smooth_shape, targetShape, smoothCoeff);
-        dtc->smooth_slope = smoothParam(dtc->smooth_slope, targetSlope, smoothCoeff);
-        dtc->smooth_smoothness = smoothParam(dtc->smooth_smoothness, targetSmoothness, smoothCoeff);
-        dtc->smooth_shift = smoothParam(dtc->smooth_shift, targetShift, smoothCoeff);
-        
-        float shape = dtc->smooth_shape;
-        float slope = dtc->smooth_slope;
-        float smoothness = dtc->smooth_smoothness;
-        float shift = dtc->smooth_shift;
+        float shape = shapeSmoother.Next();
+        float slope = slopeSmoother.Next();
+        float smoothness = smoothnessSmoother.Next();
+        float shift = shiftSmoother.Next();
         
-        if (shapeIn) shape = clamp(shape + shapeIn[i] * 0.1f * shapeAtten, 0.0f, 1.0f);
-        if (slopeIn) slope = clamp(slope + slopeIn[i] * 0.1f * slopeAtten, 0.0f, 1.0f);
-        if (smoothIn) smoothness = clamp(smoothness + smoothIn[i] * 0.1f * smoothAtten, 0.0f, 1.0f);
-        if (shiftIn) shift = clamp(shift + shiftIn[i] * 0.1f * shiftAtten, 0.0f, 1.0f);
+        if (hasMod) {
+            shape = clamp(shape + b.shapeCv[i], 0.0f, 1.0f);
+            slope = clamp(slope + b.slopeCv[i], 0.0f, 1.0f);
+            smoothness = clamp(smoothness + b.smoothCv[i], 0.0f, 1.0f);
+            shift = clamp(shift + b.shiftCv[i], 0.0f, 1.0f);
+        } else {
+            shape = clamp(shape + b.shapeOffset, 0.0f, 1.0f);
+            slope = clamp(slope + b.slopeOffset, 0.0f, 1.0f);
+            smoothness = clamp(smoothness + b.smoothOffset, 0.0f, 1.0f);
+            shift = clamp(shift + b.shiftOffset, 0.0f, 1.0f);
+        }
         
         // --- Handle gate/trigger ---
-        bool gate = false;
         bool rising = false;
+        const bool fill = band_limited && b.fillShapers && i == 0;
         
-        if (trigIn) {
-            gate = trigIn[i] > 1.0f;  // ~1V threshold
-            rising = gate && !dtc->prev_gate_high;
-            dtc->prev_gate_high = gate;
+        if (hasTrig && i == nextEdge) {
+            gate = !gate;
+            rising = gate;
+            nextEdge = ++edge < b.numGateEdges ? b.gateEdges[edge] : numFrames;
         }
         
         // --- Update phase based on ramp mode ---
-        float phaseInc = cvFreq * alg->inv_sample_rate;
+        float phaseInc = cvFreq * b.invSampleRate;
+        bool wrapped = false;
         
-        switch (rampMode) {
-            case RAMP_AD:
-                // Attack/Decay: trigger starts envelope, runs once to completion
-                if (rising) {
-                    dtc->phase[0] = 0.0f;
-                    dtc->envelope_running = true;
-                }
-                if (dtc->envelope_running) {
-                    dtc->phase[0] += phaseInc;
-                    if (dtc->phase[0] >= 1.0f) {
-                        dtc->phase[0] = 1.0f;
-                        dtc->envelope_running = false;
-                    }
-                }
-                break;
-                
-            case RAMP_CYCLE:
-                // Cyclic: free-running, trigger resets phase
-                if (rising) {
-                    dtc->phase[0] = 0.0f;
-                }
-                dtc->phase[0] += phaseInc;
-                while (dtc->phase[0] >= 1.0f) {
-                    dtc->phase[0] -= 1.0f;
-                }
-                break;
-                
-            case RAMP_AR:
-                // Attack/Release: gate high = rise, gate low = fall
-                if (gate || trigIn == nullptr) {
-                    // Rising (or free-run if no gate connected)
-                    if (trigIn == nullptr) {
-                        // No gate = free-run like cycle mode
-                        dtc->phase[0] += phaseInc;
-                        while (dtc->phase[0] >= 1.0f) {
-                            dtc->phase[0] -= 1.0f;
-                        }
-                    } else {
-                        // Gate high = attack phase
-                        float attackSpeed = phaseInc / clamp(slope, 0.01f, 0.99f);
-                        dtc->phase[0] += attackSpeed;
-                        if (dtc->phase[0] > 0.5f) dtc->phase[0] = 0.5f;  // Stop at apex
-                    }
-                } else {
-                    // Gate low = release phase
-                    float releaseSpeed = phaseInc / clamp(1.0f - slope, 0.01f, 0.99f);
-                    dtc->phase[0] += releaseSpeed;
-                    if (dtc->phase[0] > 1.0f) dtc->phase[0] = 1.0f;  // Stop at end
-                }
-                break;
+        if (ramp_mode == RAMP_AD) {
+            // Attack/Decay: trigger starts envelope, runs once to completion
+            if (rising) {
+                dtc->phase = 0;
+                dtc->envelope_running = true;
+            }
+            if (dtc->envelope_running) {
+                dtc->phase = advancePhase(dtc->phase, phaseIncrement(phaseInc), PHASE_END);
+                dtc->envelope_running = dtc->phase != PHASE_END;
+            }
+        } else if (ramp_mode == RAMP_CYCLE) {
+            // Cyclic: free-running, trigger resets phase
+            if (rising) {
+                dtc->phase = 0;
+            }
+            const uint32_t next = dtc->phase + phaseIncrement(phaseInc);
+            wrapped = next < dtc->phase;
+            dtc->phase = next;
+        } else {
+            // Attack/Release: gate high = rise, gate low = fall
+            if (!hasTrig) {
+                // No gate = free-run like cycle mode
+                const uint32_t next = dtc->phase + phaseIncrement(phaseInc);
+                wrapped = next < dtc->phase;
+                dtc->phase = next;
+            } else if (gate) {
+                // Gate high = attack phase, stopping at the apex
+                float attackSpeed = phaseInc / clamp(slope, 0.01f, 0.99f);
+                dtc->phase = advancePhase(dtc->phase, phaseIncrement(attackSpeed), PHASE_HALF);
+            } else {
+                // Gate low = release phase, stopping at the end
+                float releaseSpeed = phaseInc / clamp(1.0f - slope, 0.01f, 0.99f);
+                dtc->phase = advancePhase(dtc->phase, phaseIncrement(releaseSpeed), PHASE_END);
+            }
         }
         
         // --- Generate raw ramp and shaped output ---
-        float rawPhase = dtc->phase[0];
+        float rawPhase = (float)dtc->phase * PHASE_TO_FLOAT;
         float ramp;
         
-        if (rampMode == RAMP_AR) {
+        if (ramp_mode == RAMP_AR) {
             // AR mode: phase 0-0.5 = attack, 0.5-1.0 = release
             if (rawPhase <= 0.5f) {
                 ramp = rawPhase * 2.0f;  // 0→1 during attack
             } else {
                 ramp = 1.0f - (rawPhase - 0.5f) * 2.0f;  // 1→0 during release
             }
+        } else if (band_limited && (output_mode == OUT_GATES || output_mode == OUT_AMPLITUDE)) {
+            ramp = bandLimitedSlope(dtc->shaper[0], rawPhase, phaseInc, slope, fill);
         } else {
             // AD and Cycle modes: apply slope to create asymmetric triangle
             ramp = applySlope(rawPhase, slope);
         }
         
-        // Apply shape (waveshaping)
-        float shaped = applyShape(ramp, shape);
-        
-        // Apply smoothness (lowpass or wavefold)
-        float processed = applySmoothness(shaped, smoothness, lpState[0]);
+        // Apply shape (waveshaping), then smoothness (lowpass or wavefold).
+        // Only the main ramp's modes use it: the 4-channel modes run each
+        // channel through its own lowpass, lpState[0] included.
+        float processed = 0.0f;
+        if (output_mode == OUT_GATES || output_mode == OUT_AMPLITUDE) {
+            processed = applySmoothness(applyShape(ramp, shape), smoothness, lpState[0], b.span);
+        }
         
         // Scale to ±5V for bipolar output (Cycle mode) or 0-8V unipolar (AD/AR)
         float out1Val, out2Val, out3Val, out4Val;
         
         // --- Generate outputs based on output mode ---
-        switch (outputMode) {
-            case OUT_GATES: {
-                // Gates mode: 
-                // Out1: Main shaped signal × shift level
-                // Out2: Raw triangle (unshifted)
-                // Out3: End of Attack gate (high when past attack portion)
-                // Out4: End of Release/Ramp gate (high at end)
-                
-                float level = shift * 2.0f - 1.0f;  // Convert 0-1 to -1 to +1 for attenuverter
-                
-                if (rampMode == RAMP_CYCLE) {
-                    // Bipolar output for cycle mode
-                    out1Val = (processed * 2.0f - 1.0f) * 5.0f * fabsf(level);
-                    if (level < 0.0f) out1Val = -out1Val;
-                    out2Val = (ramp * 2.0f - 1.0f) * 5.0f;  // Raw bipolar ramp
-                } else {
-                    // Unipolar output for envelope modes
-                    out1Val = processed * 8.0f * level;
-                    out2Val = ramp * 8.0f;  // Raw unipolar ramp
-                }
-                
-                // EOA: high when past attack portion
-                bool pastAttack = (rampMode == RAMP_AR) ? (rawPhase >= 0.5f) : (rawPhase >= slope);
-                out3Val = pastAttack ? 8.0f : 0.0f;
-                
-                // EOR: high at end of cycle/envelope
-                bool atEnd = (rampMode == RAMP_CYCLE) ? (rawPhase < phaseInc * 2.0f) : (rawPhase >= 0.999f);
-                out4Val = atEnd ? 8.0f : 0.0f;
-                break;
+        if (output_mode == OUT_GATES) {
+            // Gates mode: 
+            // Out1: Main shaped signal × shift level
+            // Out2: Raw triangle (unshifted)
+            // Out3: End of Attack gate (high when past attack portion)
+            // Out4: End of Release/Ramp gate (high at end)
+            
+            float level = shift * 2.0f - 1.0f;  // Convert 0-1 to -1 to +1 for attenuverter
+            
+            if (ramp_mode == RAMP_CYCLE) {
+                // Bipolar output for cycle mode
+                out1Val = (processed * 2.0f - 1.0f) * 5.0f * fabsf(level);
+                if (level < 0.0f) out1Val = -out1Val;
+                out2Val = (ramp * 2.0f - 1.0f) * 5.0f;  // Raw bipolar ramp
+            } else {
+                // Unipolar output for envelope modes
+                out1Val = processed * 8.0f * level;
+                out2Val = ramp * 8.0f;  // Raw unipolar ramp
             }
             
-            case OUT_AMPLITUDE: {
-                // Amplitude mode: signal panned across 4 outputs based on shift
-                float signal;
-                if (rampMode == RAMP_CYCLE) {
-                    signal = (processed * 2.0f - 1.0f) * 5.0f;
-                } else {
-                    signal = processed * 8.0f;
+            // EOA: high when past attack portion
+            bool pastAttack = (ramp_mode == RAMP_AR) ? (rawPhase >= 0.5f) : (rawPhase >= slope);
+            out3Val = pastAttack ? 8.0f : 0.0f;
+            
+            // EOR: high at end of cycle/envelope
+            bool atEnd = (ramp_mode == RAMP_CYCLE) ? (rawPhase < phaseInc * 2.0f) : (rawPhase >= 0.999f);
+            out4Val = atEnd ? 8.0f : 0.0f;
+            
+            if (band_limited) {
+                // The same pulses, EOR two samples wide
+                const float eoa = dtc->shaper[2].BandLimitedPulse(rawPhase, phaseInc, slope);
+                const float eor = 1.0f - dtc->shaper[3].BandLimitedPulse(rawPhase, phaseInc, 2.0f * phaseInc);
+                if (!fill) {
+                    out3Val = eoa * 8.0f;
+                    out4Val = eor * 8.0f;
                 }
-                
-                // Shift controls which output(s) receive the signal
-                // shift=0: all to out1, shift=1: all to out4
-                float pos = shift * 3.0f;  // 0 to 3
-                
-                float gain1 = clamp(1.0f - pos, 0.0f, 1.0f);
-                float gain2 = clamp(1.0f - fabsf(pos - 1.0f), 0.0f, 1.0f);
-                float gain3 = clamp(1.0f - fabsf(pos - 2.0f), 0.0f, 1.0f);
-                float gain4 = clamp(pos - 2.0f, 0.0f, 1.0f);
-                
-                out1Val = signal * gain1;
-                out2Val = signal * gain2;
-                out3Val = signal * gain3;
-                out4Val = signal * gain4;
-                break;
             }
+        } else if (output_mode == OUT_AMPLITUDE) {
+            // Amplitude mode: signal panned across 4 outputs based on shift
+            float signal;
+            if (ramp_mode == RAMP_CYCLE) {
+                signal = (processed * 2.0f - 1.0f) * 5.0f;
+            } else {
+                signal = processed * 8.0f;
+            }
+            
+            // Shift controls which output(s) receive the signal
+            // shift=0: all to out1, shift=1: all to out4
+            float pos = shift * 3.0f;  // 0 to 3
+            
+            float gain1 = clamp(1.0f - pos, 0.0f, 1.0f);
+            float gain2 = clamp(1.0f - fabsf(pos - 1.0f), 0.0f, 1.0f);
+            float gain3 = clamp(1.0f - fabsf(pos - 2.0f), 0.0f, 1.0f);
+            float gain4 = clamp(pos - 2.0f, 0.0f, 1.0f);
             
-            case OUT_SLOPE_PHASE: {
-                // Slope/Phase mode: 4 phase-shifted copies
-                float phaseSpread = shift;  // 0 = unison, 1 = 90° spread
+            out1Val = signal * gain1;
+            out2Val = signal * gain2;
+            out3Val = signal * gain3;
+            out4Val = signal * gain4;
+        } else if (output_mode == OUT_SLOPE_PHASE) {
+            // Slope/Phase mode: 4 phase-shifted copies
+            float phaseSpread = shift;  // 0 = unison, 1 = 90° spread
+            
+            for (int k = 0; k < b.numChannels; ++k) {
+                const int ch = b.channels[k];
+                // 0, 0.25, 0.5, 0.75 at shift=1, wrapping in fixed point
+                float phaseOffset = ch * phaseSpread * 0.25f;
+                float p = (float)(dtc->phase + phaseIncrement(phaseOffset)) * PHASE_TO_FLOAT;
+                
+                float r = band_limited ? bandLimitedSlope(dtc->shaper[ch], p, phaseInc, slope, fill)
+                    : applySlope(p, slope);
+                float s = applyShape(r, shape);
+                float pr = applySmoothness(s, smoothness, lpState[ch], b.span);
                 
+                b.out[ch][i] = ramp_mode == RAMP_CYCLE ? (pr * 2.0f - 1.0f) * 5.0f : pr * 8.0f;
+            }
+        } else {
+            // Frequency mode: each output is the main phase times the ratio
+            // Shift selects from the Range's ratio table, so all four stay
+            // locked to it. As in RampGenerator, a channel takes a new ratio
+            // once the main phase has wrapped q times, where the two line up.
+            // Envelopes take it on the trigger and run a phase per channel.
+            if (rising) {
                 for (int ch = 0; ch < 4; ++ch) {
-                    float phaseOffset = ch * phaseSpread * 0.25f;  // 0, 0.25, 0.5, 0.75 at shift=1
-                    float p = rawPhase + phaseOffset;
-                    while (p >= 1.0f) p -= 1.0f;
-                    
-                    float r = applySlope(p, slope);
-                    float s = applyShape(r, shape);
-                    float pr = applySmoothness(s, smoothness, lpState[ch]);
-                    
-                    float val;
-                    if (rampMode == RAMP_CYCLE) {
-                        val = (pr * 2.0f - 1.0f) * 5.0f;
-                    } else {
-                        val = pr * 8.0f;
+                    dtc->ratio[ch] = nextRatio[ch];
+                    dtc->wrap_counter[ch] = 0;
+                    if (ramp_mode == RAMP_AD) {
+                        dtc->channel_phase[ch] = 0;
                     }
-                    
-                    switch (ch) {
-                        case 0: out1Val = val; break;
-                        case 1: out2Val = val; break;
-                        case 2: out3Val = val; break;
-                        case 3: out4Val = val; break;
+                }
+            } else if (wrapped) {
+                for (int ch = 0; ch < 4; ++ch) {
+                    if (++dtc->wrap_counter[ch] >= dtc->ratio[ch].q) {
+                        dtc->ratio[ch] = nextRatio[ch];
+                        dtc->wrap_counter[ch] = 0;
                     }
                 }
-                break;
             }
-            
-            case OUT_FREQUENCY: {
-                // Frequency mode: 4 outputs at different frequency ratios
-                // Shift selects the ratio set
-                
-                // Simple ratio sets (could be expanded)
-                static const float ratios[4][4] = {
-                    {1.0f, 0.5f, 0.25f, 0.125f},   // Octave divisions
-                    {1.0f, 0.75f, 0.5f, 0.25f},    // Mixed
-                    {1.0f, 0.667f, 0.5f, 0.333f},  // Thirds
-                    {1.0f, 2.0f, 3.0f, 4.0f}       // Harmonics
-                };
-                
-                int ratioSet = (int)(shift * 3.99f);
-                ratioSet = clamp(ratioSet, 0, 3);
-                
-                // Update phase accumulators for each channel
+            if (!looping) {
                 for (int ch = 0; ch < 4; ++ch) {
-                    if (rising) {
-                        dtc->phase[ch] = 0.0f;
-                    }
-                    
-                    float chPhaseInc = phaseInc * ratios[ratioSet][ch];
-                    dtc->phase[ch] += chPhaseInc;
-                    while (dtc->phase[ch] >= 1.0f) {
-                        dtc->phase[ch] -= 1.0f;
-                    }
-                    
-                    float r = applySlope(dtc->phase[ch], slope);
-                    float s = applyShape(r, shape);
-                    float pr = applySmoothness(s, smoothness, lpState[ch]);
-                    
-                    float val;
-                    if (rampMode == RAMP_CYCLE) {
-                        val = (pr * 2.0f - 1.0f) * 5.0f;
+                    const float chPhaseInc = phaseInc * dtc->ratio[ch].ratio;
+                    uint32_t& chPhase = dtc->channel_phase[ch];
+                    if (ramp_mode == RAMP_AD) {
+                        chPhase = advancePhase(chPhase, phaseIncrement(chPhaseInc), PHASE_END);
+                    } else if (gate) {
+                        chPhase = advancePhase(chPhase, phaseIncrement(chPhaseInc / clamp(slope, 0.01f, 0.99f)), PHASE_HALF);
                     } else {
-                        val = pr * 8.0f;
+                        chPhase = advancePhase(chPhase, phaseIncrement(chPhaseInc / clamp(1.0f - slope, 0.01f, 0.99f)), PHASE_END);
                     }
-                    
-                    switch (ch) {
-                        case 0: out1Val = val; break;
-                        case 1: out2Val = val; break;
-                        case 2: out3Val = val; break;
-                        case 3: out4Val = val; break;
+                }
+            }
+            for (int k = 0; k < b.numChannels; ++k) {
+                const int ch = b.channels[k];
+                float r;
+                if (looping) {
+                    float p = (rawPhase + (float)dtc->wrap_counter[ch]) * dtc->ratio[ch].ratio;
+                    p -= (float)(int)p;
+                    r = band_limited
+                        ? bandLimitedSlope(dtc->shaper[ch], p, phaseInc * dtc->ratio[ch].ratio, slope, fill)
+                        : applySlope(p, slope);
+                } else {
+                    const float p = (float)dtc->channel_phase[ch] * PHASE_TO_FLOAT;
+                    if (ramp_mode == RAMP_AR) {
+                        r = p <= 0.5f ? p * 2.0f : 1.0f - (p - 0.5f) * 2.0f;
+                    } else {
+                        r = applySlope(p, slope);
                     }
                 }
-                break;
+                float s = applyShape(r, shape);
+                float pr = applySmoothness(s, smoothness, lpState[ch], b.span);
+                
+                b.out[ch][i] = ramp_mode == RAMP_CYCLE ? (pr * 2.0f - 1.0f) * 5.0f : pr * 8.0f;
             }
+        }
+        
+        // --- Write to the channel lanes ---
+        // The 4-channel modes have written theirs
+        if (output_mode == OUT_GATES || output_mode == OUT_AMPLITUDE) {
+            out1[i] = out1Val;
+            out2[i] = out2Val;
+            out3[i] = out3Val;
+            out4[i] = out4Val;
+        }
+    }
+}
+
+#ifdef TIDES_ITCM
+#define CLASSIC_KERNEL(ramp_mode, output_mode, routing, band_limited) \
+    classicKernel_##ramp_mode##_##output_mode##_##routing##_##band_limited
+
+#define CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, routing, band_limited) \
+    TIDES_ITCM_CODE static void CLASSIC_KERNEL(ramp_mode, output_mode, routing, band_limited)( \
+        _TidesAlgorithm* alg, const ClassicBlock& b, float* lpState, int numFrames) { \
+        classicKernel<ramp_mode, output_mode, routing, band_limited>(alg, b, lpState, numFrames); \
+    }
+
+#define CLASSIC_KERNEL_DEFINE_ROW(ramp_mode, output_mode, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 0, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 1, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 2, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 3, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 4, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 5, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 6, band_limited) \
+    CLASSIC_KERNEL_DEFINE(ramp_mode, output_mode, 7, band_limited)
+
+#define CLASSIC_KERNEL_DEFINE_RAMP(ramp_mode, band_limited) \
+    CLASSIC_KERNEL_DEFINE_ROW(ramp_mode, OUT_GATES, band_limited) \
+    CLASSIC_KERNEL_DEFINE_ROW(ramp_mode, OUT_AMPLITUDE, band_limited) \
+    CLASSIC_KERNEL_DEFINE_ROW(ramp_mode, OUT_SLOPE_PHASE, band_limited) \
+    CLASSIC_KERNEL_DEFINE_ROW(ramp_mode, OUT_FREQUENCY, band_limited)
+
+CLASSIC_KERNEL_DEFINE_RAMP(RAMP_AD, false)
+CLASSIC_KERNEL_DEFINE_RAMP(RAMP_CYCLE, false)
+CLASSIC_KERNEL_DEFINE_RAMP(RAMP_AR, false)
+CLASSIC_KERNEL_DEFINE_RAMP(RAMP_CYCLE, true)
+
+#undef CLASSIC_KERNEL_DEFINE_RAMP
+#undef CLASSIC_KERNEL_DEFINE_ROW
+#undef CLASSIC_KERNEL_DEFINE
+#else
+#define CLASSIC_KERNEL(ramp_mode, output_mode, routing, band_limited) \
+    classicKernel<ramp_mode, output_mode, routing, band_limited>
+#endif  // TIDES_ITCM
+
+#define CLASSIC_KERNEL_ROW(ramp_mode, output_mode, band_limited) { \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 0, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 1, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 2, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 3, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 4, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 5, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 6, band_limited), \
+    CLASSIC_KERNEL(ramp_mode, output_mode, 7, band_limited) }
+
+#define CLASSIC_KERNEL_RAMP(ramp_mode, band_limited) { \
+    CLASSIC_KERNEL_ROW(ramp_mode, OUT_GATES, band_limited), \
+    CLASSIC_KERNEL_ROW(ramp_mode, OUT_AMPLITUDE, band_limited), \
+    CLASSIC_KERNEL_ROW(ramp_mode, OUT_SLOPE_PHASE, band_limited), \
+    CLASSIC_KERNEL_ROW(ramp_mode, OUT_FREQUENCY, band_limited) }
+
+// Indexed by [RampMode][OutputMode][routing]
+static const ClassicKernel classicKernels[3][4][ROUTE_COUNT] = {
+    CLASSIC_KERNEL_RAMP(RAMP_AD, false),
+    CLASSIC_KERNEL_RAMP(RAMP_CYCLE, false),
+    CLASSIC_KERNEL_RAMP(RAMP_AR, false),
+};
+
+// Cycle mode with polyBLEP, indexed by [OutputMode][routing]
+static const ClassicKernel classicBandLimitedKernels[4][ROUTE_COUNT] = CLASSIC_KERNEL_RAMP(RAMP_CYCLE, true);
+
+#undef CLASSIC_KERNEL_RAMP
+#undef CLASSIC_KERNEL_ROW
+#undef CLASSIC_KERNEL
+
+// Control-rate rendering for slow pitches: the kernel computes one frame
+// every CONTROL_RATE_DECIMATION samples, at the last sample of the block,
+// and on both sides of every gate change so edges stay sample accurate.
+// Each point advances the state by the samples since the previous one, and
+// the output is interpolated between points. Gate outputs jump instead.
+static constexpr int CONTROL_RATE_DECIMATION = 8;
+
+static void renderControlRate(_TidesAlgorithm* alg, const ClassicBlock& block, ClassicKernel kernel, bool gateOutputs, int numFrames) {
+    static const uint16_t firstFrame = 0;
+    _TidesDTC* dtc = alg->dtc;
+    
+    ClassicBlock b = block;
+    float point[4] = {};    // Unpatched channels of the 4-channel modes stay 0
+    for (int ch = 0; ch < 4; ++ch) b.out[ch] = &point[ch];
+    b.gateEdges = &firstFrame;
+    
+    bool gate = block.gateAtStart;
+    int edge = 0;
+    int last = -1;
+    while (last < numFrames - 1) {
+        // Next grid point, or the frame before and the frame of the next
+        // gate change, whichever comes first
+        const int grid = ((last + 1) / CONTROL_RATE_DECIMATION) * CONTROL_RATE_DECIMATION + CONTROL_RATE_DECIMATION - 1;
+        const int nextEdge = edge < block.numGateEdges ? block.gateEdges[edge] : numFrames;
+        int i = grid < numFrames - 1 ? grid : numFrames - 1;
+        const int edgePoint = nextEdge - 1 > last ? nextEdge - 1 : nextEdge;
+        if (edgePoint < i) i = edgePoint;
+        
+        b.gateAtStart = gate;
+        b.numGateEdges = 0;
+        if (i == nextEdge) {
+            b.numGateEdges = 1;
+            gate = !gate;
+            ++edge;
+        }
+        
+        const int span = i - last;
+        b.pitchCv = block.pitchCv + i;
+        b.shapeCv = block.shapeCv + i;
+        b.slopeCv = block.slopeCv + i;
+        b.smoothCv = block.smoothCv + i;
+        b.shiftCv = block.shiftCv + i;
+        b.span = (float)span;
+        b.invSampleRate = alg->inv_sample_rate * b.span;
+        b.smoothCoeff = blockSmoothCoeff(span);
+        kernel(alg, b, dtc->lp_state, 1);
+        
+        const float step = 1.0f / b.span;
+        for (int ch = 0; ch < 4; ++ch) {
+            float* out = block.out[ch] + last + 1;
+            if (gateOutputs && ch >= 2) {
+                for (int k = 0; k < span; ++k) out[k] = point[ch];
+            } else {
+                const float from = dtc->control_last[ch];
+                const float delta = (point[ch] - from) * step;
+                for (int k = 0; k < span; ++k) out[k] = from + delta * (float)(k + 1);
+            }
+            dtc->control_last[ch] = point[ch];
+        }
+        last = i;
+    }
+}
+
+// ============================================================================
+// CV Conditioning
+// ============================================================================
+
+// The classic kernels read modulation that is already scaled: the patched
+// inputs of a routed group are read once here, in loops with nothing else
+// in them, into the lanes of cv_block.
+
+// V/Oct In and FM In, with FM Amount, to semitones
+static void conditionPitch(float* __restrict out, const float* __restrict voct,
+                           const float* __restrict fm, float fmSemitones, int numFrames) {
+    for (int i = 0; i < numFrames; ++i) {
+        out[i] = voct[i] * 12.0f + fm[i] * fmSemitones;
+    }
+}
+
+// A modulation input to a parameter offset, with its attenuverter
+static void conditionMod(float* __restrict out, const float* __restrict in, float atten, int numFrames) {
+    for (int i = 0; i < numFrames; ++i) {
+        out[i] = in[i] * 0.1f * atten;
+    }
+}
+
+// Resolve parameters and routing for the block, then run the kernel for
+// the current mode combination
+static void renderClassic(_TidesAlgorithm* alg, float* busFrames, int numFrames) {
+    const RenderConfig& c = alg->config;
+    ClassicBlock b;
+    
+    b.frequency = alg->block_frequency;
+    b.targetShape = c.shape;
+    b.targetSlope = c.slope;
+    b.targetSmoothness = c.smoothness;
+    b.targetShift = c.shift;
+    
+    // === Get CV inputs ===
+    const float* zero = alg->zero_block;
+    const float* in[kNumInputs];
+    for (int k = 0; k < kNumInputs; ++k) {
+        const float* block = busBlock(busFrames, c.inputBus[k], numFrames);
+        in[k] = block ? block : zero;
+    }
+    const bool trigPatched = alg->clock_sync || c.inputBus[kInput_Trig] > 0;
+    if (alg->clock_sync) in[kInput_Trig] = alg->sync_block;
+    const float* voctIn = in[kInput_VOct];
+    const float* fmIn = in[kInput_FM];
+    const float* shapeIn = in[kInput_Shape];
+    const float* slopeIn = in[kInput_Slope];
+    const float* smoothIn = in[kInput_Smooth];
+    const float* shiftIn = in[kInput_Shift];
+    
+    uint32_t routing = 0;
+    if (c.pitchPatched) routing |= ROUTE_PITCH;
+    
+    // Gate pre-scan: kernels only see where the level changes
+    b.gateAtStart = alg->dtc->prev_gate_high;
+    b.gateEdges = alg->gate_edges;
+    b.numGateEdges = 0;
+    if (trigPatched) {
+        routing |= ROUTE_TRIG;
+        b.numGateEdges = scanGateEdges(in[kInput_Trig], numFrames, alg->dtc->prev_gate_high, alg->gate_edges);
+    }
+    
+    // Pitch CV held for the whole block: one lookup instead of one per sample
+    if ((routing & ROUTE_PITCH) && isBlockConstant(voctIn, numFrames) && isBlockConstant(fmIn, numFrames)) {
+        b.frequency *= tides::SemitonesToRatio(voctIn[0] * 12.0f + fmIn[0] * c.fmSemitones);
+        routing &= ~ROUTE_PITCH;
+    }
+    
+    // Modulation CV that is held (or nearly) for the block is added once
+    // as an offset instead of per sample
+    b.shapeOffset = 0.0f;
+    b.slopeOffset = 0.0f;
+    b.smoothOffset = 0.0f;
+    b.shiftOffset = 0.0f;
+    if (c.modPatched) {
+        if (isBlockConstant(shapeIn, numFrames, MOD_CV_TOLERANCE) &&
+            isBlockConstant(slopeIn, numFrames, MOD_CV_TOLERANCE) &&
+            isBlockConstant(smoothIn, numFrames, MOD_CV_TOLERANCE) &&
+            isBlockConstant(shiftIn, numFrames, MOD_CV_TOLERANCE)) {
+            b.shapeOffset = shapeIn[0] * 0.1f * c.shapeAtten;
+            b.slopeOffset = slopeIn[0] * 0.1f * c.slopeAtten;
+            b.smoothOffset = smoothIn[0] * 0.1f * c.smoothAtten;
+            b.shiftOffset = shiftIn[0] * 0.1f * c.shiftAtten;
+        } else {
+            routing |= ROUTE_MOD;
+        }
+    }
+    
+    // === Condition the CV the kernel reads per sample ===
+    const size_t lane = NT_globals.maxFramesPerStep;
+    float* cv = alg->cv_block;
+    b.pitchCv = zero;
+    b.shapeCv = zero;
+    b.slopeCv = zero;
+    b.smoothCv = zero;
+    b.shiftCv = zero;
+    if (routing & ROUTE_PITCH) {
+        conditionPitch(cv + CV_PITCH * lane, voctIn, fmIn, c.fmSemitones, numFrames);
+        b.pitchCv = cv + CV_PITCH * lane;
+    }
+    if (routing & ROUTE_MOD) {
+        conditionMod(cv + CV_SHAPE * lane, shapeIn, c.shapeAtten, numFrames);
+        conditionMod(cv + CV_SLOPE * lane, slopeIn, c.slopeAtten, numFrames);
+        conditionMod(cv + CV_SMOOTH * lane, smoothIn, c.smoothAtten, numFrames);
+        conditionMod(cv + CV_SHIFT * lane, shiftIn, c.shiftAtten, numFrames);
+        b.shapeCv = cv + CV_SHAPE * lane;
+        b.slopeCv = cv + CV_SLOPE * lane;
+        b.smoothCv = cv + CV_SMOOTH * lane;
+        b.shiftCv = cv + CV_SHIFT * lane;
+    }
+    
+    // === Render into the channel lanes ===
+    for (int ch = 0; ch < 4; ++ch) b.out[ch] = alg->channel_block + ch * lane;
+    b.channels = c.patched;
+    b.numChannels = c.numPatched;
+    if (c.outputMode == OUT_SLOPE_PHASE || c.outputMode == OUT_FREQUENCY) {
+        for (int ch = 0; ch < 4; ++ch) {
+            if (c.outputBus[ch] <= 0) memset(b.out[ch], 0, numFrames * sizeof(float));
+        }
+    }
+    
+    b.span = 1.0f;
+    b.invSampleRate = alg->inv_sample_rate;
+    b.smoothCoeff = blockSmoothCoeff(numFrames);
+    b.ratioTable = c.range == RANGE_HIGH ? tides::audio_ratio_table : tides::control_ratio_table;
+    
+    // Control rate and anti-aliasing, decided once per block from the phase
+    // increment at its start. Control rate stops below the pitch where the
+    // band-limited kernels would start.
+    _TidesDTC* dtc = alg->dtc;
+    float increment = b.frequency * b.invSampleRate;
+    if (routing & ROUTE_PITCH) {
+        increment *= tides::SemitonesToRatio(b.pitchCv[0]);
+    }
+    const bool controlRate = c.controlRate &&
+        increment < (dtc->control_rate ? CONTROL_RATE_OFF_INCREMENT : CONTROL_RATE_ON_INCREMENT);
+    dtc->control_rate = controlRate;
+    bool bandLimited = false;
+    if (c.rampMode == RAMP_CYCLE && !controlRate && c.antiAliasing != ANTI_ALIAS_OFF) {
+        bandLimited = true;
+        if (c.antiAliasing == ANTI_ALIAS_AUTO) {
+            bandLimited = increment > (dtc->band_limited ? BLEP_OFF_INCREMENT : BLEP_ON_INCREMENT);
+        }
+    }
+    b.fillShapers = !dtc->band_limited;
+    dtc->band_limited = bandLimited;
+    
+    // Envelope channels start at rest for the Ramp Mode: AD ones at their
+    // end, AR ones on the main phase, so that the 1:1 channel is the same
+    // envelope as the main ramp
+    if (c.rampMode != dtc->channel_ramp_mode) {
+        for (int ch = 0; ch < 4; ++ch) {
+            dtc->channel_phase[ch] = c.rampMode == RAMP_AR ? dtc->phase : PHASE_END;
+        }
+        dtc->channel_ramp_mode = c.rampMode;
+    }
+    
+    ClassicKernel kernel = bandLimited ? classicBandLimitedKernels[c.outputMode][routing]
+        : classicKernels[c.rampMode][c.outputMode][routing];
+#ifdef TIDES_ITCM
+    kernel = itcmKernel(alg->itcm, 0, ITCM_CLASSIC_SLOTS, kernel);
+#endif
+    if (controlRate) {
+        renderControlRate(alg, b, kernel, c.outputMode == OUT_GATES, numFrames);
+    } else {
+        kernel(alg, b, dtc->lp_state, numFrames);
+        // Control rate interpolates on from the last frame
+        for (int ch = 0; ch < 4; ++ch) dtc->control_last[ch] = b.out[ch][numFrames - 1];
+    }
+    writeOutputs(c, b.out, busFrames, numFrames);
+}
+
+// ============================================================================
+// Extra Voices
+// ============================================================================
+
+// Per-block routing and shared parameters for the voice loop
+struct VoiceBlock {
+    const float* trig[MAX_VOICES];
+    float* out[MAX_VOICES];
+    const float* accumulate[MAX_VOICES];
+    bool trigPatched[MAX_VOICES];
+    bool gate[MAX_VOICES];          // MIDI: gate level for the whole block
+    
+    // Voices the kernel steps; the rest are idle
+    uint8_t active[MAX_VOICES];
+    int numActive;
+    
+    const float* shapeIn;
+    const float* slopeIn;
+    const float* smoothIn;
+    
+    float targetShape;
+    float targetSlope;
+    float targetSmoothness;
+    float smoothCoeff;      // Parameter smoothing over the block
+    
+    // CV to parameter scale, including the attenuverters
+    float shapeScale;
+    float slopeScale;
+    float smoothScale;
+};
+
+// All voices share the main parameters and modulation; each has its own
+// gate, pitch and output. The inner loop runs across the voice arrays.
+// With midi the gates come from b.gate instead of the trigger inputs.
+template <RampMode ramp_mode, bool midi>
+TIDES_ITCM_INLINE static void voiceKernel(_TidesVoices& voices, const VoiceBlock& b, int numFrames) {
+    const int n = b.numActive;
+    tides::ParameterInterpolator shapeSmoother(&voices.smooth_shape,
+        smoothParam(voices.smooth_shape, b.targetShape, b.smoothCoeff), numFrames);
+    tides::ParameterInterpolator slopeSmoother(&voices.smooth_slope,
+        smoothParam(voices.smooth_slope, b.targetSlope, b.smoothCoeff), numFrames);
+    tides::ParameterInterpolator smoothnessSmoother(&voices.smooth_smoothness,
+        smoothParam(voices.smooth_smoothness, b.targetSmoothness, b.smoothCoeff), numFrames);
+    uint32_t* const phase = voices.phase;
+    float* const lpState = voices.lp_state;
+    const float* const phaseInc = voices.phase_inc;
+    uint8_t* const gateHigh = voices.gate_high;
+    uint8_t* const running = voices.envelope_running;
+    
+    for (int i = 0; i < numFrames; ++i) {
+        const float shape = clamp(shapeSmoother.Next() + b.shapeIn[i] * b.shapeScale, 0.0f, 1.0f);
+        const float slope = clamp(slopeSmoother.Next() + b.slopeIn[i] * b.slopeScale, 0.0f, 1.0f);
+        const float smoothness = clamp(smoothnessSmoother.Next() + b.smoothIn[i] * b.smoothScale, 0.0f, 1.0f);
+        
+        // AR attack/release rates, shared by every voice
+        const float attackScale = 1.0f / clamp(slope, 0.01f, 0.99f);
+        const float releaseScale = 1.0f / clamp(1.0f - slope, 0.01f, 0.99f);
+        
+        for (int k = 0; k < n; ++k) {
+            const int v = b.active[k];
+            const bool gate = midi ? b.gate[v] : b.trig[v][i] > 1.0f;
+            const bool rising = gate && !gateHigh[v];
+            gateHigh[v] = gate;
+            
+            uint32_t p = phase[v];
+            if (ramp_mode == RAMP_AD) {
+                if (rising) {
+                    p = 0;
+                    running[v] = 1;
+                }
+                if (running[v]) {
+                    p = advancePhase(p, phaseIncrement(phaseInc[v]), PHASE_END);
+                    running[v] = p != PHASE_END;
+                }
+            } else if (ramp_mode == RAMP_CYCLE) {
+                if (rising) p = 0;
+                p += phaseIncrement(phaseInc[v]);
+            } else {
+                if (!b.trigPatched[v]) {
+                    p += phaseIncrement(phaseInc[v]);
+                } else if (gate) {
+                    p = advancePhase(p, phaseIncrement(phaseInc[v] * attackScale), PHASE_HALF);
+                } else {
+                    p = advancePhase(p, phaseIncrement(phaseInc[v] * releaseScale), PHASE_END);
+                }
+                running[v] = gate || p != PHASE_END;
+            }
+            phase[v] = p;
+            const float phaseValue = (float)p * PHASE_TO_FLOAT;
             
-            default:
-                out1Val = out2Val = out3Val = out4Val = 0.0f;
-                break;
+            float ramp;
+            if (ramp_mode == RAMP_AR) {
+                ramp = phaseValue <= 0.5f ? phaseValue * 2.0f : 1.0f - (phaseValue - 0.5f) * 2.0f;
+            } else {
+                ramp = applySlope(phaseValue, slope);
+            }
+            
+            const float processed = applySmoothness(applyShape(ramp, shape), smoothness, lpState[v]);
+            const float value = ramp_mode == RAMP_CYCLE ? (processed * 2.0f - 1.0f) * 5.0f : processed * 8.0f;
+            b.out[v][i] = b.accumulate[v][i] + value;
         }
+    }
+}
+
+typedef void (*VoiceKernel)(_TidesVoices& voices, const VoiceBlock& b, int numFrames);
+
+#ifdef TIDES_ITCM
+#define VOICE_KERNEL(ramp_mode, midi) voiceKernel_##ramp_mode##_##midi
+
+#define VOICE_KERNEL_DEFINE(ramp_mode, midi) \
+    TIDES_ITCM_CODE static void VOICE_KERNEL(ramp_mode, midi)( \
+        _TidesVoices& voices, const VoiceBlock& b, int numFrames) { \
+        voiceKernel<ramp_mode, midi>(voices, b, numFrames); \
+    }
+
+VOICE_KERNEL_DEFINE(RAMP_AD, false)
+VOICE_KERNEL_DEFINE(RAMP_AD, true)
+VOICE_KERNEL_DEFINE(RAMP_CYCLE, false)
+VOICE_KERNEL_DEFINE(RAMP_CYCLE, true)
+VOICE_KERNEL_DEFINE(RAMP_AR, false)
+VOICE_KERNEL_DEFINE(RAMP_AR, true)
+
+#undef VOICE_KERNEL_DEFINE
+#else
+#define VOICE_KERNEL(ramp_mode, midi) voiceKernel<ramp_mode, midi>
+#endif  // TIDES_ITCM
+
+// Indexed by [RampMode][midi]
+static const VoiceKernel voiceKernels[3][2] = {
+    { VOICE_KERNEL(RAMP_AD, false), VOICE_KERNEL(RAMP_AD, true) },
+    { VOICE_KERNEL(RAMP_CYCLE, false), VOICE_KERNEL(RAMP_CYCLE, true) },
+    { VOICE_KERNEL(RAMP_AR, false), VOICE_KERNEL(RAMP_AR, true) },
+};
+
+#undef VOICE_KERNEL
+
+#ifdef TIDES_ITCM
+// Every kernel in the ITCM section, and the largest of each kind
+static void scanItcmCode() {
+    ItcmCode& code = itcmCode;
+    if (code.scanned) return;
+    
+    // Classic kernels first, then the voice kernels
+    uintptr_t entries[ITCM_MAX_KERNELS];
+    int count = 0;
+    for (const auto& ramp : classicKernels) {
+        for (const auto& output : ramp) {
+            for (ClassicKernel kernel : output) entries[count++] = codeAddress(kernel);
+        }
+    }
+    for (const auto& output : classicBandLimitedKernels) {
+        for (ClassicKernel kernel : output) entries[count++] = codeAddress(kernel);
+    }
+    const int numClassic = count;
+    for (const auto& ramp : voiceKernels) {
+        for (VoiceKernel kernel : ramp) entries[count++] = codeAddress(kernel);
+    }
+    
+    // Sorted copy for itcmExtent(): insertion sort, once per process
+    code.count = count;
+    for (int i = 0; i < count; ++i) {
+        int j = i;
+        for (; j > 0 && code.start[j - 1] > entries[i]; --j) code.start[j] = code.start[j - 1];
+        code.start[j] = entries[i];
+    }
+    
+    code.max_classic = 0;
+    code.max_voice = 0;
+    for (int i = 0; i < count; ++i) {
+        uint32_t& largest = i < numClassic ? code.max_classic : code.max_voice;
+        const uint32_t size = itcmExtent(entries[i]);
+        if (size > largest) largest = size;
+    }
+    code.scanned = true;
+}
+
+static_assert(3 * 4 * ROUTE_COUNT + 4 * ROUTE_COUNT + 3 * 2 <= ITCM_MAX_KERNELS,
+              "ITCM_MAX_KERNELS must cover every kernel table");
+#endif  // TIDES_ITCM
+
+// Smoothness lowpass state below which an idle MIDI voice is taken as
+// having settled on 0V
+static constexpr float VOICE_IDLE_LEVEL = 1.0e-6f;
+
+static void renderVoices(_TidesAlgorithm* alg, float* busFrames, int numFrames) {
+    const RenderConfig& c = alg->config;
+    _TidesVoices& voices = alg->voices;
+    const float* zero = alg->zero_block;
+    VoiceBlock b;
+    
+    b.targetShape = c.shape;
+    b.targetSlope = c.slope;
+    b.targetSmoothness = c.smoothness;
+    b.smoothCoeff = blockSmoothCoeff(numFrames);
+    b.shapeScale = c.shapeScale;
+    b.slopeScale = c.slopeScale;
+    b.smoothScale = c.smoothScale;
+    
+    const float* shapeIn = busBlock(busFrames, c.inputBus[kInput_Shape], numFrames);
+    const float* slopeIn = busBlock(busFrames, c.inputBus[kInput_Slope], numFrames);
+    const float* smoothIn = busBlock(busFrames, c.inputBus[kInput_Smooth], numFrames);
+    b.shapeIn = shapeIn ? shapeIn : zero;
+    b.slopeIn = slopeIn ? slopeIn : zero;
+    b.smoothIn = smoothIn ? smoothIn : zero;
+    
+    // Pitch is taken once per block per voice
+    const float baseInc = alg->block_frequency * alg->inv_sample_rate;
+    const bool midi = c.midiChannel > 0;
+    
+    b.numActive = 0;
+    for (int v = 0; v < voices.count; ++v) {
+        const float* trig = busBlock(busFrames, c.voiceTrigBus[v], numFrames);
+        const float* voct = busBlock(busFrames, c.voiceVOctBus[v], numFrames);
+        float* out = busBlock(busFrames, c.voiceOutputBus[v], numFrames);
+        
+        b.trig[v] = trig ? trig : zero;
+        b.trigPatched[v] = trig != nullptr;
+        b.out[v] = out ? out : alg->sink_block;
+        b.accumulate[v] = (out && !c.voiceReplace[v]) ? out : zero;
         
-        // --- Write to output buses ---
-        if (out1) {
-            if (out1Replace) out1[i] = out1Val;
-            else out1[i] += out1Val;
+        if (!midi) {
+            voices.phase_inc[v] = voct ? baseInc * tides::SemitonesToRatio(voct[0] * 12.0f) : baseInc;
+            b.active[b.numActive++] = v;
+            continue;
+        }
+        
+        // A note on since the last block gates the voice for at least this
+        // one, and starts its envelope from a rising edge even if it was
+        // already held
+        VoiceAllocator& a = alg->midi;
+        b.gate[v] = a.held[v] || a.retrigger[v];
+        b.trigPatched[v] = true;
+        if (a.retrigger[v]) voices.gate_high[v] = 0;
+        a.retrigger[v] = false;
+        voices.phase_inc[v] = baseInc * tides::SemitonesToRatio((float)(a.note[v] - MIDI_NOTE_ZERO_VOLTS));
+        
+        // A finished envelope with no note rests at 0V and is not stepped
+        const bool idle = c.rampMode != RAMP_CYCLE && !b.gate[v] && !voices.envelope_running[v] &&
+            fabsf(voices.lp_state[v]) < VOICE_IDLE_LEVEL;
+        if (!idle) {
+            b.active[b.numActive++] = v;
+        } else if (out && c.voiceReplace[v]) {
+            voices.lp_state[v] = 0.0f;
+            memset(out, 0, numFrames * sizeof(float));
+        } else {
+            voices.lp_state[v] = 0.0f;
+        }
+    }
+    
+    VoiceKernel kernel = voiceKernels[c.rampMode][midi];
+#ifdef TIDES_ITCM
+    kernel = itcmKernel(alg->itcm, ITCM_CLASSIC_SLOTS, 1, kernel);
+#endif
+    kernel(voices, b, numFrames);
+}
+
+// Voice for a note on: the voice already holding the note, else the next
+// one round robin that is not held, else the one with the oldest note
+static int allocateVoice(VoiceAllocator& a, int numVoices, uint8_t note) {
+    for (int v = 0; v < numVoices; ++v) {
+        if (a.held[v] && a.note[v] == note) return v;
+    }
+    for (int k = 1; k <= numVoices; ++k) {
+        const int v = (a.last + k) % numVoices;
+        if (!a.held[v]) return v;
+    }
+    int oldest = 0;
+    for (int v = 1; v < numVoices; ++v) {
+        if (a.age[v] - a.age[oldest] > 0x80000000u) oldest = v;
+    }
+    return oldest;
+}
+
+#ifndef TIDES_PROFILE
+
+// Fold the block's channel lanes, which hold the engine's own outputs
+// before the output stage adds them to a bus, into the pending scope column
+// every scopeStride frames, and publish it once it spans its share of the
+// screen
+static void captureScope(_TidesAlgorithm* alg, int numFrames) {
+    const RenderConfig& c = alg->config;
+    TidesScope& scope = alg->scope;
+    
+    const int stride = c.scopeStride;
+    const int first = scope.next_point;
+    for (int k = 0; k < c.numPatched; ++k) {
+        const int ch = c.patched[k];
+        const float* out = alg->channel_block + ch * NT_globals.maxFramesPerStep;
+        float lo = scope.pending_min[ch];
+        float hi = scope.pending_max[ch];
+        for (int i = first; i < numFrames; i += stride) {
+            lo = fminf(lo, out[i]);
+            hi = fmaxf(hi, out[i]);
+        }
+        scope.pending_min[ch] = lo;
+        scope.pending_max[ch] = hi;
+    }
+    scope.next_point = first < numFrames ? stride - 1 - (numFrames - 1 - first) % stride : first - numFrames;
+    
+    const float phase = alg->active_engine == ENGINE_TIDES2 ? alg->poly->phase(0)
+        : (float)alg->dtc->phase * PHASE_TO_FLOAT;
+    scope.phase.store(phase, std::memory_order_relaxed);
+    
+    scope.pending_frames += numFrames;
+    if (scope.pending_frames < c.scopeFramesPerColumn) return;
+    
+    const uint32_t written = scope.written.load(std::memory_order_relaxed);
+    ScopeColumn& column = scope.ring[written & (SCOPE_RING_SIZE - 1)];
+    for (int ch = 0; ch < 4; ++ch) {
+        const bool empty = scope.pending_min[ch] > scope.pending_max[ch];
+        column.min[ch] = empty ? 0 : (int8_t)clamp(scope.pending_min[ch] * SCOPE_VOLTS_TO_Q7, -127.0f, 127.0f);
+        column.max[ch] = empty ? 0 : (int8_t)clamp(scope.pending_max[ch] * SCOPE_VOLTS_TO_Q7, -127.0f, 127.0f);
+    }
+    scope.written.store(written + 1, std::memory_order_release);
+    resetScopeColumn(scope);
+}
+
+#endif  // TIDES_PROFILE
+
+void step(_NT_algorithm* self, float* busFrames, int numFramesBy4) {
+    _TidesAlgorithm* alg = (_TidesAlgorithm*)self;
+    int numFrames = numFramesBy4 * 4;
+    
+#ifdef TIDES_PROFILE
+    const uint32_t profileStart = readCycleCounter();
+#endif
+    
+    // Start the newly selected engine from a clean state
+    const int engine = alg->config.engine;
+    if (engine != alg->active_engine) {
+        if (engine == ENGINE_TIDES2) {
+            alg->poly->Init();
+            alg->poly_gate_high = false;
+        } else {
+            initClassic(alg->dtc);
         }
-        if (out2) {
-            if (out2Replace) out2[i] = out2Val;
-            else out2[i] += out2Val;
+        alg->active_engine = engine;
+    }
+    
+    // Clock In: the measured tempo times the ratio picked by Frequency
+    // replaces the Frequency parameter, and in Cycle mode the sync pulses
+    // stand in for Trig/Gate to keep the phase locked
+    const RenderConfig& c = alg->config;
+    const float* clockIn = busBlock(busFrames, c.clockBus, numFrames);
+    alg->block_frequency = c.frequency;
+    alg->clock_sync = false;
+    if (clockIn) {
+        ClockTracker& clock = alg->clock;
+        trackClock(clock, clockIn, numFrames, alg->sync_block, c.clockRatio->q,
+                   (uint32_t)(CLOCK_TIMEOUT_SECONDS * NT_globals.sampleRate));
+        if (clock.period != 0) {
+            alg->block_frequency = c.clockRatio->ratio * NT_globals.sampleRate
+                * (float)(1 << CLOCK_PERIOD_SHIFT) / (float)clock.period;
         }
-        if (out3) {
-            if (out3Replace) out3[i] = out3Val;
-            else out3[i] += out3Val;
+        alg->clock_sync = c.rampMode == RAMP_CYCLE;
+    }
+    
+    if (engine == ENGINE_TIDES2) {
+        renderTides2(alg, busFrames, numFrames);
+    } else {
+        renderClassic(alg, busFrames, numFrames);
+    }
+    // Profiling builds show the load instead of the scope, so the measured
+    // cost is the engine's only
+#ifndef TIDES_PROFILE
+    captureScope(alg, numFrames);
+#endif
+    
+    if (alg->voices.count > 0) {
+        renderVoices(alg, busFrames, numFrames);
+    }
+    
+#ifdef TIDES_PROFILE
+    recordProfile(alg->profile, readCycleCounter() - profileStart, numFrames);
+#endif
+}
+
+#ifdef TIDES_PROFILE
+
+// Append a label and a number to a text buffer
+static char* appendText(char* p, const char* text) {
+    while (*text) *p++ = *text++;
+    *p = 0;
+    return p;
+}
+
+static char* appendInt(char* p, const char* label, int32_t value) {
+    p = appendText(p, label);
+    p += NT_intToString(p, value);
+    return p;
+}
+
+static char* appendFloat(char* p, const char* label, float value, int decimals) {
+    p = appendText(p, label);
+    p += NT_floatToString(p, value, decimals);
+    return p;
+}
+
+// Load readout: current mode and min/avg/max cycles of the last window
+static void drawProfile(const _TidesAlgorithm* alg) {
+    const TidesProfile& prof = alg->profile;
+    char text[64];
+    char* p;
+    
+    p = appendText(text, engineNames[alg->v[kParam_Engine]]);
+    p = appendText(p, ": ");
+    p = appendText(p, rampModeNames[alg->v[kParam_RampMode]]);
+    p = appendText(p, " / ");
+    p = appendText(p, rangeNames[alg->v[kParam_Range]]);
+    p = appendText(p, " / ");
+    appendText(p, outputModeNames[alg->v[kParam_OutputMode]]);
+    NT_drawText(0, 30, text);
+    
+    p = appendInt(text, "Block  min ", prof.shown_block_min);
+    p = appendInt(p, "  avg ", prof.shown_block_avg);
+    appendInt(p, "  max ", prof.shown_block_max);
+    NT_drawText(0, 42, text);
+    
+    p = appendFloat(text, "Sample min ", prof.shown_sample_min, 1);
+    p = appendFloat(p, "  avg ", prof.shown_sample_avg, 1);
+    appendFloat(p, "  max ", prof.shown_sample_max, 1);
+    NT_drawText(0, 52, text);
+    
+    const float cyclesPerSample = PROFILE_CPU_HZ / (float)NT_globals.sampleRate;
+    p = appendFloat(text, "Load ", 100.0f * prof.shown_sample_avg / cyclesPerSample, 2);
+    p = appendFloat(p, "%  peak ", 100.0f * prof.shown_sample_max / cyclesPerSample, 2);
+    appendText(p, "%");
+    NT_drawText(0, 62, text);
+}
+
+#else
+
+// Scope: the main ramp phase as a bar, then one lane per patched output
+// showing the min/max of each published column, newest on the right
+static void drawScope(const _TidesAlgorithm* alg) {
+    const TidesScope& scope = alg->scope;
+    static constexpr int laneTop = 16;
+    static constexpr int laneHeight = 12;
+    
+    const float phase = scope.phase.load(std::memory_order_relaxed);
+    NT_drawShapeI(kNT_rectangle, 0, 13, (int)(clamp(phase, 0.0f, 1.0f) * (SCOPE_WIDTH - 1)), 14, 8);
+    
+    // Ramp In and Phase Out belong to the Tides 2 engine
+    const RenderConfig& c = alg->config;
+    if (c.engine != ENGINE_TIDES2 && (c.rampBus > 0 || c.phaseBus > 0)) {
+        NT_drawText(SCOPE_WIDTH - 1, 20, "Ramp In/Phase Out: Tides 2 only", 8, kNT_textRight, kNT_textTiny);
+    }
+    
+    const uint32_t written = scope.written.load(std::memory_order_acquire);
+    const int count = written < (uint32_t)SCOPE_WIDTH ? (int)written : SCOPE_WIDTH;
+    for (int ch = 0; ch < 4; ++ch) {
+        if (c.outputBus[ch] <= 0) continue;
+        const int centre = laneTop + ch * laneHeight + laneHeight / 2;
+        NT_drawShapeI(kNT_line, 0, centre, SCOPE_WIDTH - 1, centre, 2);
+        for (int k = 0; k < count; ++k) {
+            const ScopeColumn& column = scope.ring[(written - count + k) & (SCOPE_RING_SIZE - 1)];
+            const int x = SCOPE_WIDTH - count + k;
+            const int y0 = centre - column.max[ch] * (laneHeight / 2 - 1) / 127;
+            const int y1 = centre - column.min[ch] * (laneHeight / 2 - 1) / 127;
+            NT_drawShapeI(kNT_line, x, y0, x, y1, 15);
         }
-        if (out4) {
-            if (out4Replace) out4[i] = out4Val;
-            else out4[i] += out4Val;
+    }
+}
+
+#endif  // TIDES_PROFILE
+
+// With PROFILE=1 the load readout takes the place of the scope
+bool draw(_NT_algorithm* self) {
+    const _TidesAlgorithm* alg = (const _TidesAlgorithm*)self;
+#ifdef TIDES_PROFILE
+    drawProfile(alg);
+#else
+    drawScope(alg);
+#endif
+    return false;
+}
+
+// ============================================================================
+// MIDI
+// ============================================================================
+
+// Note on/off on the MIDI Channel play the voices; All Notes Off and All
+// Sound Off release them
+void midiMessage(_NT_algorithm* self, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
+    _TidesAlgorithm* alg = (_TidesAlgorithm*)self;
+    const int channel = alg->config.midiChannel;
+    const int numVoices = alg->voices.count;
+    if (channel == 0 || numVoices == 0 || (byte0 & 0x0F) != channel - 1) return;
+    
+    VoiceAllocator& a = alg->midi;
+    const uint8_t status = byte0 & 0xF0;
+    if (status == 0x90 && byte2 > 0) {
+        const int v = allocateVoice(a, numVoices, byte1);
+        a.note[v] = byte1;
+        a.held[v] = true;
+        a.retrigger[v] = true;
+        a.age[v] = ++a.counter;
+        a.last = v;
+    } else if (status == 0x80 || status == 0x90) {
+        for (int v = 0; v < numVoices; ++v) {
+            if (a.note[v] == byte1) a.held[v] = false;
         }
+    } else if (status == 0xB0 && (byte1 == 120 || byte1 == 123)) {
+        for (int v = 0; v < numVoices; ++v) a.held[v] = false;
     }
 }
 
@@ -680,17 +2692,17 @@ static const _NT_factory factory = {
     .guid = NT_MULTICHAR('T', 'i', 'd', '2'),
     .name = "Tides 2",
     .description = "Tidal Modulator - LFO/Envelope/VCO",
-    .numSpecifications = 0,
-    .specifications = nullptr,
-    .calculateStaticRequirements = nullptr,
-    .initialise = nullptr,
+    .numSpecifications = kNumSpecs,
+    .specifications = specifications,
+    .calculateStaticRequirements = calculateStaticRequirements,
+    .initialise = initialise,
     .calculateRequirements = calculateRequirements,
     .construct = construct,
     .parameterChanged = parameterChanged,
     .step = step,
-    .draw = nullptr,
+    .draw = draw,
     .midiRealtime = nullptr,
-    .midiMessage = nullptr,
+    .midiMessage = midiMessage,
     .tags = kNT_tagUtility,
     .hasCustomUi = nullptr,
     .customUi = nullptr,
@@ -13,6 +13,22 @@
 
 #include "tides_resources.h"
 
+#if defined(TIDES_Q15_SHAPE) && defined(__ARM_FEATURE_DSP)
+#include <arm_acle.h>
+#endif
+
+// Four-lane vectors for the per-channel loops on desktop hosts. The
+// Cortex-M7 has neither SSE2 nor NEON and keeps the scalar code, as does
+// any build with TIDES_NO_SIMD.
+#if !defined(TIDES_NO_SIMD) && (defined(__SSE2__) || defined(__ARM_NEON))
+#define TIDES_SIMD4
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#else
+#include <arm_neon.h>
+#endif
+#endif
+
 namespace tides {
 
 // ============================================================================
@@ -47,6 +63,98 @@ inline float InterpolateWrap(const float* table, float index, float size) {
     return a + (b - a) * index_fractional;
 }
 
+// ============================================================================
+// Four-Lane Vectors (host builds with SSE2 or NEON)
+// ============================================================================
+
+// Each lane does exactly the arithmetic of the scalar code it replaces, in
+// the same order and without fused multiply-adds, so the results match.
+#ifdef TIDES_SIMD4
+
+#if defined(__SSE2__)
+typedef __m128 Float4;
+typedef __m128i Int4;
+
+inline Float4 Load4(const float* p) { return _mm_loadu_ps(p); }
+inline void Store4(float* p, Float4 a) { _mm_storeu_ps(p, a); }
+inline Float4 Splat4(float x) { return _mm_set1_ps(x); }
+inline Float4 Add4(Float4 a, Float4 b) { return _mm_add_ps(a, b); }
+inline Float4 Sub4(Float4 a, Float4 b) { return _mm_sub_ps(a, b); }
+inline Float4 Mul4(Float4 a, Float4 b) { return _mm_mul_ps(a, b); }
+inline Int4 Truncate4(Float4 a) { return _mm_cvttps_epi32(a); }
+inline Float4 ToFloat4(Int4 a) { return _mm_cvtepi32_ps(a); }
+inline void StoreInt4(int32_t* p, Int4 a) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); }
+#else
+typedef float32x4_t Float4;
+typedef int32x4_t Int4;
+
+inline Float4 Load4(const float* p) { return vld1q_f32(p); }
+inline void Store4(float* p, Float4 a) { vst1q_f32(p, a); }
+inline Float4 Splat4(float x) { return vdupq_n_f32(x); }
+inline Float4 Add4(Float4 a, Float4 b) { return vaddq_f32(a, b); }
+inline Float4 Sub4(Float4 a, Float4 b) { return vsubq_f32(a, b); }
+inline Float4 Mul4(Float4 a, Float4 b) { return vmulq_f32(a, b); }
+inline Int4 Truncate4(Float4 a) { return vcvtq_s32_f32(a); }
+inline Float4 ToFloat4(Int4 a) { return vcvtq_f32_s32(a); }
+inline void StoreInt4(int32_t* p, Int4 a) { vst1q_s32(p, a); }
+#endif
+
+// Interpolate() on four indices: the table reads are scalar
+inline Float4 Interpolate4(const float* table, Float4 index, float size) {
+    index = Mul4(index, Splat4(size));
+    const Int4 integral = Truncate4(index);
+    const Float4 fractional = Sub4(index, ToFloat4(integral));
+    int32_t i[4];
+    StoreInt4(i, integral);
+    float a[4];
+    float b[4];
+    for (int k = 0; k < 4; ++k) {
+        a[k] = table[i[k]];
+        b[k] = table[i[k] + 1];
+    }
+    const Float4 a4 = Load4(a);
+    return Add4(a4, Mul4(Sub4(Load4(b), a4), fractional));
+}
+
+#endif  // TIDES_SIMD4
+
+// Semitones to frequency ratio, from the pitch ratio tables: one lookup per
+// semitone, linear interpolation across 1/256 semitone steps. Exponents are
+// clamped to +/-128 semitones.
+inline float SemitonesToRatio(float semitones) {
+    float pitch = semitones + 128.0f;
+    CONSTRAIN(pitch, 0.0f, 255.9999f);
+    MAKE_INTEGRAL_FRACTIONAL(pitch)
+    float low = pitch_fractional * 256.0f;
+    MAKE_INTEGRAL_FRACTIONAL(low)
+    float a = lut_pitch_ratio_low[low_integral];
+    float b = lut_pitch_ratio_low[low_integral + 1];
+    return lut_pitch_ratio_high[pitch_integral] * (a + (b - a) * low_fractional);
+}
+
+// Packed 16-bit dual multiply-accumulate: acc + lo(a) * lo(b) + hi(a) * hi(b).
+// A single SMLAD on cores with the DSP extension.
+inline int32_t Smlad(uint32_t a, uint32_t b, int32_t acc) {
+#if defined(TIDES_Q15_SHAPE) && defined(__ARM_FEATURE_DSP)
+    return __smlad(a, b, acc);
+#else
+    return acc +
+        static_cast<int16_t>(a) * static_cast<int16_t>(b) +
+        static_cast<int16_t>(a >> 16) * static_cast<int16_t>(b >> 16);
+#endif
+}
+
+inline uint32_t Pack16(int32_t low, int32_t high) {
+    return (static_cast<uint32_t>(low) & 0xffff) | (static_cast<uint32_t>(high) << 16);
+}
+
+// Two adjacent table entries as one packed word
+inline uint32_t LoadPair16(const int16_t* p) {
+    uint32_t pair;
+    memcpy(&pair, p, sizeof(pair));
+    return pair;
+}
+
 // PolyBLEP functions for anti-aliasing
 inline float ThisBlepSample(float t) {
     return 0.5f * t * t;
@@ -57,19 +165,15 @@ inline float NextBlepSample(float t) {
     return -0.5f * t * t;
 }
 
-inline float ThisIntegratedBlepSample(float t) {
+inline float NextIntegratedBlepSample(float t) {
     const float t1 = 0.5f * t;
     const float t2 = t1 * t1;
     const float t4 = t2 * t2;
-    return 0.1875f - t1 + 1.5f * t2 - t2 * t1 - t4 + t4 * t1;
+    return 0.1875f - t1 + 1.5f * t2 - t4;
 }
 
-inline float NextIntegratedBlepSample(float t) {
-    t = 1.0f - t;
-    const float t1 = 0.5f * t;
-    const float t2 = t1 * t1;
-    const float t4 = t2 * t2;
-    return 0.1875f - t1 + 1.5f * t2 - t2 * t1 - t4 + t4 * t1;
+inline float ThisIntegratedBlepSample(float t) {
+    return NextIntegratedBlepSample(1.0f - t);
 }
 
 // ============================================================================
@@ -191,6 +295,7 @@ public:
     
     inline float phase(size_t index) const { return phase_[index]; }
     inline float frequency(size_t index) const { return frequency_[index]; }
+    inline float master_phase() const { return master_phase_; }
     
     inline void Init() {
         master_phase_ = 0.0f;
@@ -281,7 +386,10 @@ public:
                     for (size_t i = 0; i < n; ++i) {
                         frequency_[i] = std::min(f0 * ratio_[i].ratio, 0.25f);
                     }
-                    if (ramp < master_phase_) {
+                    if (gate_flags & GATE_FLAG_RISING) {
+                        std::copy(&next_ratio_[0], &next_ratio_[n], &ratio_[0]);
+                        std::fill(&wrap_counter_[0], &wrap_counter_[n], 0);
+                    } else if (ramp < master_phase_) {
                         for (size_t i = 0; i < n; ++i) {
                             ++wrap_counter_[i];
                             if (wrap_counter_[i] >= ratio_[i].q) {
@@ -410,7 +518,7 @@ public:
     }
     
     template<RampMode ramp_mode, Range range>
-    inline float EOR(float phase, float frequency, float pw) {
+    inline float EOR(float phase, float frequency, float /* pw */) {
         if (ramp_mode == RAMP_MODE_LOOPING) {
             const float eor_pw = std::min(0.5f, 96.0f * frequency);
             if (range == RANGE_AUDIO) {
@@ -423,7 +531,6 @@ public:
         }
     }
 
-private:
     inline float BandLimitedSlope(float phase, float phase_shift, float frequency, float pw) {
         if (phase_shift != 0.0f) {
             phase += phase_shift;
@@ -475,6 +582,7 @@ private:
         return this_sample;
     }
     
+private:
     inline float SkewedRamp(float phase, float phase_shift, float frequency, float pw) {
         if (phase_shift != 0.0f) {
             phase += phase_shift;
@@ -499,6 +607,90 @@ private:
     float previous_phase_shift_;
 };
 
+// ============================================================================
+// Shared Tables
+// ============================================================================
+
+// Wavetable sample type. Q15 builds interpolate the int16 table in flash;
+// float builds read a copy already scaled to ±1, so the shaping loop has no
+// int16 to float conversions.
+#ifdef TIDES_Q15_SHAPE
+typedef int16_t ShapeSample;
+#else
+typedef float ShapeSample;
+#endif
+
+// The float path shapes and folds four channels at once where it can
+#if defined(TIDES_SIMD4) && !defined(TIDES_Q15_SHAPE)
+#define TIDES_SIMD4_SHAPE
+#endif
+
+// Tables built once per plugin load and read by every instance
+class SharedTables {
+public:
+    SharedTables() { }
+    ~SharedTables() { }
+    
+    void Init() {
+#ifndef TIDES_Q15_SHAPE
+        for (int32_t i = 0; i < LUT_WAVETABLE_SIZE; ++i) {
+            wavetable_[i] = static_cast<float>(lut_wavetable[i]) / 32768.0f;
+        }
+#endif
+    }
+    
+    inline const ShapeSample* wavetable() const {
+#ifdef TIDES_Q15_SHAPE
+        return lut_wavetable;
+#else
+        return wavetable_;
+#endif
+    }
+
+private:
+#ifndef TIDES_Q15_SHAPE
+    float wavetable_[LUT_WAVETABLE_SIZE];
+#endif
+};
+
+// ============================================================================
+// Shape Row Cache
+// ============================================================================
+
+// Copy of the wavetable row pair the shape is on, next to the engine state.
+// Refilled between blocks only; a sample whose row is not cached reads the
+// source table instead.
+class ShapeRowCache {
+public:
+    static constexpr int32_t kRowSize = 1025;
+    static constexpr int32_t kNumRows = LUT_WAVETABLE_SIZE / kRowSize;
+    
+    ShapeRowCache() { }
+    ~ShapeRowCache() { }
+    
+    void Init(const ShapeSample* wavetable) {
+        wavetable_ = wavetable;
+        row_ = -1;
+    }
+    
+    inline void Update(int32_t row) {
+        CONSTRAIN(row, 0, kNumRows - 2);
+        if (row != row_) {
+            memcpy(rows_, &wavetable_[row * kRowSize], sizeof(rows_));
+            row_ = row;
+        }
+    }
+    
+    inline const ShapeSample* rows(int32_t row) const {
+        return row == row_ ? rows_ : &wavetable_[row * kRowSize];
+    }
+
+private:
+    const ShapeSample* wavetable_;
+    int32_t row_;
+    ShapeSample rows_[2 * kRowSize];
+};
+
 // ============================================================================
 // Ramp Waveshaper
 // ============================================================================
@@ -515,17 +707,29 @@ public:
     }
     
     template<RampMode ramp_mode>
-    inline float Shape(float input, const int16_t* shape, float shape_fractional) {
+    inline float Shape(float input, const ShapeSample* shape, float shape_fractional) {
         float ws_index = 1024.0f * input;
         MAKE_INTEGRAL_FRACTIONAL(ws_index)
         ws_index_integral &= 1023;
-        float x0 = static_cast<float>(shape[ws_index_integral]) / 32768.0f;
-        float x1 = static_cast<float>(shape[ws_index_integral + 1]) / 32768.0f;
-        float y0 = static_cast<float>(shape[ws_index_integral + 1025]) / 32768.0f;
-        float y1 = static_cast<float>(shape[ws_index_integral + 1026]) / 32768.0f;
+#ifdef TIDES_Q15_SHAPE
+        // Rows stay in Q15; Q14 weights keep 1.0 representable in 16 bits,
+        // so each blend is one dual MAC and the result is converted once.
+        const int32_t w = static_cast<int32_t>(ws_index_fractional * 16384.0f);
+        const int32_t s = static_cast<int32_t>(shape_fractional * 16384.0f);
+        const uint32_t index_weights = Pack16(16384 - w, w);
+        const int32_t x = Smlad(LoadPair16(&shape[ws_index_integral]), index_weights, 0) >> 14;
+        const int32_t y = Smlad(LoadPair16(&shape[ws_index_integral + 1025]), index_weights, 0) >> 14;
+        float output = static_cast<float>(Smlad(Pack16(x, y), Pack16(16384 - s, s), 0)) *
+            (1.0f / (32768.0f * 16384.0f));
+#else
+        float x0 = shape[ws_index_integral];
+        float x1 = shape[ws_index_integral + 1];
+        float y0 = shape[ws_index_integral + 1025];
+        float y1 = shape[ws_index_integral + 1026];
         float x = x0 + (x1 - x0) * ws_index_fractional;
         float y = y0 + (y1 - y0) * ws_index_fractional;
         float output = x + (y - x) * shape_fractional;
+#endif  // TIDES_Q15_SHAPE
         
         if (ramp_mode != RAMP_MODE_AR) {
             return output;
@@ -573,6 +777,22 @@ public:
     
     template<size_t num_effective_channels>
     inline void Process(float* f, float* in_out, size_t size) {
+#ifdef TIDES_SIMD4
+        if (num_channels == 4 && num_effective_channels == 4) {
+            // One vector per frame, with the state kept in registers
+            const Float4 coefficient = Load4(f);
+            Float4 lp_1 = Load4(lp_1_);
+            Float4 lp_2 = Load4(lp_2_);
+            for (; size--; in_out += 4) {
+                lp_1 = Add4(lp_1, Mul4(coefficient, Sub4(Load4(in_out), lp_1)));
+                lp_2 = Add4(lp_2, Mul4(coefficient, Sub4(lp_1, lp_2)));
+                Store4(in_out, lp_2);
+            }
+            Store4(lp_1_, lp_1);
+            Store4(lp_2_, lp_2);
+            return;
+        }
+#endif  // TIDES_SIMD4
         while (size--) {
             for (size_t i = 0; i < num_effective_channels; ++i) {
                 ONE_POLE(lp_1_[i], *in_out, f[i]);
@@ -592,7 +812,21 @@ private:
 // Ratio Tables
 // ============================================================================
 
-static Ratio audio_ratio_table[21][4] = {
+// All lookup tables are const so they stay in flash (.rodata) instead of
+// being copied to RAM at load. The wavetable is read through SharedTables
+// and the row pair held in ShapeRowCache.
+
+// Clock multiplication/division, locked every q clock periods
+static const Ratio clock_ratio_table[21] = {
+    { 0.0625f, 16 }, { 0.08333333f, 12 }, { 0.125f, 8 }, { 0.16666667f, 6 },
+    { 0.2f, 5 }, { 0.25f, 4 }, { 0.33333333f, 3 }, { 0.5f, 2 },
+    { 0.66666667f, 3 }, { 0.75f, 4 }, { 1.0f, 1 }, { 1.33333333f, 3 },
+    { 1.5f, 2 }, { 2.0f, 1 }, { 3.0f, 1 }, { 4.0f, 1 },
+    { 5.0f, 1 }, { 6.0f, 1 }, { 8.0f, 1 }, { 12.0f, 1 },
+    { 16.0f, 1 },
+};
+
+static const Ratio audio_ratio_table[21][4] = {
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.25f, 4 }, { 0.125f, 8 } },
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.33333333f, 3 }, { 0.2f, 5 } },
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.33333333f, 3 }, { 0.25f, 4 } },
@@ -616,7 +850,7 @@ static Ratio audio_ratio_table[21][4] = {
     { { 1.0f, 1 }, { 2.0f, 1 }, { 4.0f, 1 }, { 8.0f, 1 } },
 };
 
-static Ratio control_ratio_table[21][4] = {
+static const Ratio control_ratio_table[21][4] = {
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.25f, 4 }, { 0.125f, 8 } },
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.33333333f, 3 }, { 0.2f, 5 } },
     { { 1.0f, 1 }, { 0.5f, 2 }, { 0.33333333f, 3 }, { 0.25f, 4 } },
@@ -652,9 +886,29 @@ public:
         float channel[num_channels];
     };
     
-    PolySlopeGenerator() { }
+    PolySlopeGenerator() : wavetable_(nullptr), shape_cache_(nullptr) { }
     ~PolySlopeGenerator() { }
     
+    // Wavetable to shape with: SharedTables::wavetable(). Must be set
+    // before rendering; survives Init().
+    void set_wavetable(const ShapeSample* wavetable) {
+        wavetable_ = wavetable;
+        if (shape_cache_) {
+            shape_cache_->Init(wavetable_);
+        }
+    }
+    
+    // Optional copy of the active wavetable rows in fast memory; the
+    // generator refills it. Survives Init().
+    void set_shape_cache(ShapeRowCache* shape_cache) {
+        shape_cache_ = shape_cache;
+        if (shape_cache_) {
+            shape_cache_->Init(wavetable_);
+        }
+    }
+    
+    inline float phase(size_t channel) const { return ramp_generator_.phase(channel); }
+    
     void Reset() {
         filter_.Init();
     }
@@ -675,6 +929,11 @@ public:
         ratio_index_quantizer_.Init(21, 0.05f, false);
     }
     
+    // ramp, when given, replaces the internal phase integration with an
+    // external 0-1 ramp, and a rising gate flag marks a reset of that ramp
+    // rather than a wrap. phase_out receives the phase per sample: the master
+    // phase the ratio channels are derived from, or channel 0's phase in the
+    // modes without one.
     void Render(
             RampMode ramp_mode,
             OutputMode output_mode,
@@ -687,7 +946,13 @@ public:
             const GateFlags* gate_flags,
             const float* ramp,
             OutputSample* out,
-            size_t size) {
+            size_t size,
+            size_t num_active_channels = num_channels,
+            float* phase_out = nullptr) {
+        
+        // Channels past the last one in use are not rendered (except in
+        // Gates mode, where each output has its own function)
+        active_channels_ = std::min(std::max(num_active_channels, size_t(1)), num_channels);
         
         const float max_ratio = 1.0f;
         frequency = std::min(frequency, 0.25f * max_ratio);
@@ -714,7 +979,7 @@ public:
         
         // Dispatch to the correct render function
         RenderDispatch(ramp_mode, output_mode, range,
-            frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+            frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
         
         if (smoothness < 0.5f) {
             float ratio = smoothness * 2.0f;
@@ -722,16 +987,17 @@ public:
             ratio *= ratio;
             
             float f[4];
-            size_t last_channel = output_mode == OUTPUT_MODE_GATES ? 1 : num_channels;
+            size_t last_channel = output_mode == OUTPUT_MODE_GATES ? 1 : active_channels_;
             for (size_t i = 0; i < last_channel; ++i) {
                 size_t source = output_mode == OUTPUT_MODE_FREQUENCY ? i : 0;
                 f[i] = ramp_generator_.frequency(source) * 0.5f;
                 f[i] += (1.0f - f[i]) * ratio;
             }
-            if (output_mode == OUTPUT_MODE_GATES) {
-                filter_.Process<1>(f, &out[0].channel[0], size);
-            } else {
-                filter_.Process<num_channels>(f, &out[0].channel[0], size);
+            switch (last_channel) {
+                case 1: filter_.Process<1>(f, &out[0].channel[0], size); break;
+                case 2: filter_.Process<2>(f, &out[0].channel[0], size); break;
+                case 3: filter_.Process<3>(f, &out[0].channel[0], size); break;
+                default: filter_.Process<num_channels>(f, &out[0].channel[0], size); break;
             }
         }
     }
@@ -743,32 +1009,32 @@ private:
             Range range,
             float frequency, float pw, float shape, float smoothness, float shift,
             const GateFlags* gate_flags, const float* ramp,
-            OutputSample* out, size_t size) {
+            OutputSample* out, float* phase_out, size_t size) {
         
         // Dispatch based on mode combination
         if (ramp_mode == RAMP_MODE_AD) {
             if (range == RANGE_CONTROL) {
                 RenderInternal<RAMP_MODE_AD, RANGE_CONTROL>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             } else {
                 RenderInternal<RAMP_MODE_AD, RANGE_AUDIO>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             }
         } else if (ramp_mode == RAMP_MODE_AR) {
             if (range == RANGE_CONTROL) {
                 RenderInternal<RAMP_MODE_AR, RANGE_CONTROL>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             } else {
                 RenderInternal<RAMP_MODE_AR, RANGE_AUDIO>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             }
         } else {
             if (range == RANGE_CONTROL) {
                 RenderInternal<RAMP_MODE_LOOPING, RANGE_CONTROL>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             } else {
                 RenderInternal<RAMP_MODE_LOOPING, RANGE_AUDIO>(
-                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, size);
+                    output_mode, frequency, pw, shape, smoothness, shift, gate_flags, ramp, out, phase_out, size);
             }
         }
     }
@@ -778,9 +1044,11 @@ private:
             OutputMode output_mode,
             float frequency, float pw, float shape, float smoothness, float shift,
             const GateFlags* gate_flags, const float* ramp,
-            OutputSample* out, size_t size) {
+            OutputSample* out, float* phase_out, size_t size) {
         
         const bool is_phasor = !(range == RANGE_AUDIO && ramp_mode == RAMP_MODE_LOOPING);
+        const bool has_master_phase = ramp_mode == RAMP_MODE_LOOPING &&
+            !(range == RANGE_AUDIO && output_mode == OUTPUT_MODE_FREQUENCY);
         
         ParameterInterpolator fm(&frequency_, frequency, size);
         ParameterInterpolator pwm(&pw_, pw, size);
@@ -790,6 +1058,10 @@ private:
         ParameterInterpolator fold_modulation(
             &fold_, std::max(2.0f * (smoothness - 0.5f), 0.0f), size);
         
+        if (shape_cache_) {
+            shape_cache_->Update(static_cast<int32_t>(shape_));
+        }
+        
         if (output_mode == OUTPUT_MODE_FREQUENCY) {
             const int ratio_index = ratio_index_quantizer_.Process(shift);
             if (range == RANGE_CONTROL) {
@@ -820,7 +1092,7 @@ private:
             if (output_mode == OUTPUT_MODE_SLOPE_PHASE && ramp_mode == RAMP_MODE_AR) {
                 if (ramp) {
                     ramp_generator_.Step<ramp_mode, OUTPUT_MODE_SLOPE_PHASE, range, true>(
-                        f0, per_channel_pw, GATE_FLAG_LOW, ramp_val);
+                        f0, per_channel_pw, gf, ramp_val);
                 } else {
                     ramp_generator_.Step<ramp_mode, OUTPUT_MODE_SLOPE_PHASE, range, false>(
                         f0, per_channel_pw, gf, 0.0f);
@@ -829,16 +1101,16 @@ private:
                 if (ramp) {
                     if (output_mode == OUTPUT_MODE_GATES) {
                         ramp_generator_.Step<ramp_mode, OUTPUT_MODE_GATES, range, true>(
-                            f0, &this_pw, GATE_FLAG_LOW, ramp_val);
+                            f0, &this_pw, gf, ramp_val);
                     } else if (output_mode == OUTPUT_MODE_AMPLITUDE) {
                         ramp_generator_.Step<ramp_mode, OUTPUT_MODE_AMPLITUDE, range, true>(
-                            f0, &this_pw, GATE_FLAG_LOW, ramp_val);
+                            f0, &this_pw, gf, ramp_val);
                     } else if (output_mode == OUTPUT_MODE_SLOPE_PHASE) {
                         ramp_generator_.Step<ramp_mode, OUTPUT_MODE_SLOPE_PHASE, range, true>(
-                            f0, &this_pw, GATE_FLAG_LOW, ramp_val);
+                            f0, &this_pw, gf, ramp_val);
                     } else {
                         ramp_generator_.Step<ramp_mode, OUTPUT_MODE_FREQUENCY, range, true>(
-                            f0, &this_pw, GATE_FLAG_LOW, ramp_val);
+                            f0, &this_pw, gf, ramp_val);
                     }
                 } else {
                     if (output_mode == OUTPUT_MODE_GATES) {
@@ -857,10 +1129,18 @@ private:
                 }
             }
             
+            if (phase_out) {
+                phase_out[i] = has_master_phase
+                    ? ramp_generator_.master_phase()
+                    : ramp_generator_.phase(0);
+            }
+            
             // Compute shape
             const float shape_val = shape_modulation.Next();
             MAKE_INTEGRAL_FRACTIONAL(shape_val);
-            const int16_t* shape_table = &lut_wavetable[shape_val_integral * 1025];
+            const ShapeSample* shape_table = shape_cache_
+                ? shape_cache_->rows(shape_val_integral)
+                : &wavetable_[shape_val_integral * ShapeRowCache::kRowSize];
             
             if (output_mode == OUTPUT_MODE_GATES) {
                 const float phase = ramp_generator_.phase(0);
@@ -870,7 +1150,7 @@ private:
                 
                 out[i].channel[0] = Fold<ramp_mode>(slope, fold) * this_shift;
                 out[i].channel[1] = Scale<ramp_mode>(is_phasor
-                    ? ramp_waveshaper_[1].Shape<ramp_mode>(raw, &lut_wavetable[8200], 0.0f)
+                    ? ramp_waveshaper_[1].Shape<ramp_mode>(raw, &wavetable_[8200], 0.0f)
                     : raw);
                 out[i].channel[2] = ramp_shaper_[2].EOA<ramp_mode, range>(phase, freq, this_pw) * 8.0f;
                 out[i].channel[3] = ramp_shaper_[3].EOR<ramp_mode, range>(phase, freq, this_pw) * 8.0f;
@@ -881,7 +1161,7 @@ private:
                 const float shaped = ramp_waveshaper_[0].Shape<ramp_mode>(raw, shape_table, shape_val_fractional);
                 const float slope = Fold<ramp_mode>(shaped, fold) * (this_shift < 0.0f ? -1.0f : 1.0f);
                 const float channel_index = fabsf(this_shift * 5.1f);
-                for (size_t j = 0; j < num_channels; ++j) {
+                for (size_t j = 0; j < active_channels_; ++j) {
                     const float channel = static_cast<float>(j + 1);
                     const float gain = std::max(1.0f - fabsf(channel - channel_index), 0.0f);
                     const bool equal_pow = range == RANGE_AUDIO;
@@ -889,7 +1169,23 @@ private:
                 }
             } else if (output_mode == OUTPUT_MODE_SLOPE_PHASE) {
                 float phase_shift = 0.0f;
-                for (size_t j = 0; j < num_channels; ++j) {
+#ifdef TIDES_SIMD4_SHAPE
+                if (ramp_mode != RAMP_MODE_AR && active_channels_ == num_channels) {
+                    float raw[num_channels];
+                    for (size_t j = 0; j < num_channels; ++j) {
+                        raw[j] = ramp_shaper_[j].Slope<ramp_mode, range>(
+                            ramp_generator_.phase(0),
+                            phase_shift,
+                            ramp_generator_.frequency(0),
+                            ramp_mode == RAMP_MODE_AD ? per_channel_pw[j] : this_pw);
+                        phase_shift -= range == RANGE_AUDIO ? step : partial_step;
+                    }
+                    Store4(out[i].channel, Fold4<ramp_mode>(
+                        Shape4(raw, shape_table, shape_val_fractional), fold));
+                    continue;
+                }
+#endif  // TIDES_SIMD4_SHAPE
+                for (size_t j = 0; j < active_channels_; ++j) {
                     size_t source = ramp_mode == RAMP_MODE_AR ? j : 0;
                     out[i].channel[j] = Fold<ramp_mode>(
                         ramp_waveshaper_[j].Shape<ramp_mode>(
@@ -904,7 +1200,22 @@ private:
                     phase_shift -= range == RANGE_AUDIO ? step : partial_step;
                 }
             } else if (output_mode == OUTPUT_MODE_FREQUENCY) {
-                for (size_t j = 0; j < num_channels; ++j) {
+#ifdef TIDES_SIMD4_SHAPE
+                if (ramp_mode != RAMP_MODE_AR && active_channels_ == num_channels) {
+                    float raw[num_channels];
+                    for (size_t j = 0; j < num_channels; ++j) {
+                        raw[j] = ramp_shaper_[j].Slope<ramp_mode, range>(
+                            ramp_generator_.phase(j),
+                            0.0f,
+                            ramp_generator_.frequency(j),
+                            this_pw);
+                    }
+                    Store4(out[i].channel, Fold4<ramp_mode>(
+                        Shape4(raw, shape_table, shape_val_fractional), fold));
+                    continue;
+                }
+#endif  // TIDES_SIMD4_SHAPE
+                for (size_t j = 0; j < active_channels_; ++j) {
                     out[i].channel[j] = Fold<ramp_mode>(
                         ramp_waveshaper_[j].Shape<ramp_mode>(
                             ramp_shaper_[j].Slope<ramp_mode, range>(
@@ -938,6 +1249,54 @@ private:
         }
     }
     
+#ifdef TIDES_SIMD4_SHAPE
+    // RampWaveshaper::Shape() on four channels, without the AR breakpoints,
+    // which need each channel's previous sample
+    static inline Float4 Shape4(const float* input, const ShapeSample* shape, float shape_fractional) {
+        const Float4 ws_index = Mul4(Splat4(1024.0f), Load4(input));
+        const Int4 integral = Truncate4(ws_index);
+        const Float4 fractional = Sub4(ws_index, ToFloat4(integral));
+        int32_t index[num_channels];
+        StoreInt4(index, integral);
+        float x0[num_channels];
+        float x1[num_channels];
+        float y0[num_channels];
+        float y1[num_channels];
+        for (size_t j = 0; j < num_channels; ++j) {
+            const int32_t n = index[j] & 1023;
+            x0[j] = shape[n];
+            x1[j] = shape[n + 1];
+            y0[j] = shape[n + 1025];
+            y1[j] = shape[n + 1026];
+        }
+        const Float4 x0_4 = Load4(x0);
+        const Float4 y0_4 = Load4(y0);
+        const Float4 x = Add4(x0_4, Mul4(Sub4(Load4(x1), x0_4), fractional));
+        const Float4 y = Add4(y0_4, Mul4(Sub4(Load4(y1), y0_4), fractional));
+        return Add4(x, Mul4(Sub4(y, x), Splat4(shape_fractional)));
+    }
+    
+    // Fold() on four channels
+    template<RampMode ramp_mode>
+    inline Float4 Fold4(Float4 unipolar, float fold_amount) {
+        const Float4 amount = Splat4(fold_amount);
+        if (ramp_mode == RAMP_MODE_LOOPING) {
+            const Float4 bipolar = Sub4(Mul4(Splat4(2.0f), unipolar), Splat4(1.0f));
+            const Float4 folded = fold_amount > 0.0f ? Interpolate4(
+                lut_bipolar_fold,
+                Add4(Splat4(0.5f), Mul4(bipolar, Splat4(0.03f + 0.46f * fold_amount))),
+                1024.0f) : Splat4(0.0f);
+            return Mul4(Splat4(5.0f), Add4(bipolar, Mul4(Sub4(folded, bipolar), amount)));
+        } else {
+            const Float4 folded = fold_amount > 0.0f ? Interpolate4(
+                lut_unipolar_fold,
+                Mul4(unipolar, amount),
+                1024.0f) : Splat4(0.0f);
+            return Mul4(Splat4(8.0f), Add4(unipolar, Mul4(Sub4(folded, unipolar), amount)));
+        }
+    }
+#endif  // TIDES_SIMD4_SHAPE
+    
     template<RampMode ramp_mode>
     inline float Scale(float unipolar) {
         if (ramp_mode == RAMP_MODE_LOOPING) {
@@ -961,6 +1320,9 @@ private:
     float shape_;
     float fold_;
     
+    const ShapeSample* wavetable_;
+    ShapeRowCache* shape_cache_;
+    size_t active_channels_;
     HysteresisQuantizer2 ratio_index_quantizer_;
     RampGenerator<num_channels> ramp_generator_;
     RampShaper ramp_shaper_[num_channels];